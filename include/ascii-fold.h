@@ -0,0 +1,58 @@
+#ifndef ASCII_FOLD_H
+#define ASCII_FOLD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * ASCII case-folding table. Unlike tolower()/strcasecmp() it never consults the locale,
+ * so folding is a single table load per byte.
+ */
+extern const unsigned char ascii_fold_table[256];
+
+/**
+ * Lower-cases one ASCII byte; other bytes are returned unchanged.
+ */
+static inline unsigned char ascii_fold(unsigned char c) { return ascii_fold_table[c]; }
+
+/**
+ * Compares two byte spans of the same length, ignoring ASCII case.
+ * Exact matches, the common case for IDs and codes, are settled by a single memcmp.
+ */
+static inline bool ascii_equal_nocase(const char* a, const char* b, size_t len) {
+    if (memcmp(a, b, len) == 0) {
+        return true;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (ascii_fold_table[(unsigned char)a[i]] != ascii_fold_table[(unsigned char)b[i]]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Orders two NUL-terminated strings by their ASCII case-folded bytes, as strcasecmp()
+ * does in the C locale.
+ */
+static inline int ascii_compare_nocase(const char* a, const char* b) {
+    const unsigned char* x = (const unsigned char*)a;
+    const unsigned char* y = (const unsigned char*)b;
+    while (*x != '\0' && ascii_fold_table[*x] == ascii_fold_table[*y]) {
+        x++;
+        y++;
+    }
+    return (int)ascii_fold_table[*x] - (int)ascii_fold_table[*y];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ASCII_FOLD_H
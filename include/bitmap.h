@@ -0,0 +1,44 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of 64-bit words needed to hold `bits` bits. */
+#define BITMAP_WORDS(bits) (((bits) + 63) / 64)
+
+/**
+ * Tests bit `i` of a bitmap.
+ */
+static inline bool bitmap_test(const uint64_t* bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1u; }
+
+/**
+ * Sets bit `i` of a bitmap.
+ */
+static inline void bitmap_set(uint64_t* bits, size_t i) { bits[i >> 6] |= (uint64_t)1 << (i & 63); }
+
+/**
+ * Clears bit `i` of a bitmap.
+ */
+static inline void bitmap_clear(uint64_t* bits, size_t i) { bits[i >> 6] &= ~((uint64_t)1 << (i & 63)); }
+
+/**
+ * Returns the index of the lowest set bit of a non-zero word.
+ */
+static inline unsigned bitmap_lowest(uint64_t word) { return (unsigned)__builtin_ctzll(word); }
+
+/**
+ * Returns the number of set bits in a word.
+ */
+static inline unsigned bitmap_popcount(uint64_t word) { return (unsigned)__builtin_popcountll(word); }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // BITMAP_H
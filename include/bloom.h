@@ -0,0 +1,65 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bitmap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bits per block filter: 8 bits per row of a full 64K-row block (power of two). */
+#define BLOOM_BLOCK_BITS ((size_t)1 << 19)
+
+/** 64-bit words per block filter. */
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+
+/** Probes per key; with 8 bits per key this gives roughly a 2% false-positive rate. */
+#define BLOOM_HASHES 6
+
+/**
+ * Spreads a key hash over all 64 bits (splitmix64 finalizer), so weak hashes still probe well.
+ */
+static inline uint64_t bloom_mix(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+/**
+ * Adds a key hash to a block filter.
+ */
+static inline void bloom_add(uint64_t* filter, uint64_t hash) {
+    uint64_t h  = bloom_mix(hash);
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1u;
+    for (uint32_t i = 0; i < BLOOM_HASHES; i++) {
+        bitmap_set(filter, (h1 + i * h2) & (BLOOM_BLOCK_BITS - 1));
+    }
+}
+
+/**
+ * Checks whether a key hash may be in a block filter (false means definitely absent).
+ */
+static inline bool bloom_may_contain(const uint64_t* filter, uint64_t hash) {
+    uint64_t h  = bloom_mix(hash);
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1u;
+    for (uint32_t i = 0; i < BLOOM_HASHES; i++) {
+        if (!bitmap_test(filter, (h1 + i * h2) & (BLOOM_BLOCK_BITS - 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // BLOOM_H
@@ -0,0 +1,324 @@
+#ifndef COLUMN_CACHE_H
+#define COLUMN_CACHE_H
+
+#include <solidc/arena.h>
+#include <solidc/csvparser.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bitmap.h"
+#include "bloom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Field contains ',', '"' or a newline, so CSV output must quote it. */
+#define FIELD_NEEDS_QUOTING 0x01
+
+/** Field has leading or trailing whitespace. */
+#define FIELD_HAS_EDGE_SPACE 0x02
+
+/** Trimmed field is a plain decimal number (e.g. "-12", "3.5e2"). */
+#define FIELD_IS_NUMERIC 0x04
+
+/** Field contains a tab, newline or carriage return that display output must replace. */
+#define FIELD_HAS_CONTROL 0x08
+
+/** Saturation value of FieldInfo.lead/trail; the edge is re-measured when reached. */
+#define FIELD_EDGE_MAX 0xFF
+
+/** Length and shape of one cell, measured once so later passes need no strlen/strchr. */
+typedef struct {
+    uint32_t len;   // Byte length of the field
+    uint8_t lead;   // Leading whitespace bytes (saturates at FIELD_EDGE_MAX)
+    uint8_t trail;  // Trailing whitespace bytes (saturates at FIELD_EDGE_MAX)
+    uint8_t flags;  // FIELD_* bits
+} FieldInfo;
+
+/**
+ * Rows per block. Numeric cells are parsed and zone maps kept per block; this is a
+ * multiple of the where batch size, so a batch never straddles two blocks.
+ */
+#define ZONE_ROWS 65536
+
+/** Min/max of the numeric cells of one block (min > max when the block has none). */
+typedef struct {
+    double min;
+    double max;
+} Zone;
+
+/** Min/max timestamp of one block (min > max when the block has none). */
+typedef struct {
+    int64_t min;
+    int64_t max;
+} TimeRange;
+
+/** How the rows of a column are ordered (ColumnVector.order, TimeVector.order). */
+#define COLUMN_ORDER_KNOWN 0x01  // The other bits have been computed or loaded
+#define COLUMN_ORDER_ASC   0x02  // Every row is >= the one before it
+#define COLUMN_ORDER_DESC  0x04  // Every row is <= the one before it
+#define COLUMN_ORDER_DENSE 0x08  // Every cell holds a value: a number other than NaN, or a timestamp
+
+/** Pre-parsed ISO-8601 timestamps of one column, indexed by data row. */
+typedef struct {
+    bool loaded;              // Have all blocks been parsed?
+    int64_t* values;          // Microseconds since the epoch (0 where the cell is not a timestamp)
+    uint64_t* valid;          // Bitmap: cell parsed as a timestamp
+    size_t valid_count;       // Number of timestamp cells in the parsed blocks
+    uint64_t* loaded_blocks;  // Bitmap: blocks whose cells have been parsed
+    TimeRange* ranges;        // Per-block min/max, NULL until known
+    uint8_t order;            // COLUMN_ORDER_* bits of the timestamps in row order (ASC/DESC only when DENSE)
+} TimeVector;
+
+/** Inferred type of a column. */
+typedef enum {
+    COLUMN_TYPE_EMPTY,    // Every cell is blank
+    COLUMN_TYPE_NUMERIC,  // Every non-blank cell parses as a number
+    COLUMN_TYPE_TEXT,     // At least one non-blank cell is not numeric
+} ColumnType;
+
+/** Pre-parsed values of one column, indexed by data row. */
+typedef struct {
+    bool loaded;              // Have all blocks of the column been parsed?
+    ColumnType type;          // Inferred column type
+    double* values;           // Parsed number per row (0 where the cell is not numeric)
+    uint64_t* numeric;        // Bitmap: cell parsed as a number
+    uint64_t* blank;          // Bitmap: cell is missing or whitespace only
+    size_t numeric_count;     // Number of numeric cells
+    size_t blank_count;       // Number of blank cells
+    FieldInfo* fields;        // Per-row field info, NULL until first requested
+    uint64_t* field_blocks;   // Bitmap: blocks whose field info has been measured
+    bool fields_complete;     // Has every block been measured?
+    uint64_t* loaded_blocks;  // Bitmap: blocks whose cells have been parsed
+    Zone* zones;              // Per-block min/max, NULL until known
+    uint64_t* blooms;         // Per-block Bloom filters of trimmed, case-folded cells, NULL if not built
+    uint8_t order;            // COLUMN_ORDER_* bits of the cells in row order, in sort order
+    TimeVector times;         // Timestamp view, parsed only when a where clause compares against a date
+    char** text;              // Computed columns: cell text, formatted on first request (NULL otherwise)
+} ColumnVector;
+
+/**
+ * Lazily populated typed view over the data rows.
+ * Each block of a column is parsed at most once, on first use.
+ */
+typedef struct {
+    Arena* arena;           // Owner of all vectors
+    Row** rows;             // Data rows (header excluded)
+    size_t row_count;       // Number of data rows
+    size_t col_count;       // Number of columns that can be cached
+    ColumnVector* columns;  // One slot per column
+    size_t* order;          // File position of each row after column_cache_permute(), NULL while in file order
+} ColumnCache;
+
+/**
+ * Initializes a cache over the data rows.
+ * @param cache Cache to initialize.
+ * @param arena Arena that owns the parsed vectors.
+ * @param rows Data rows (header excluded).
+ * @param row_count Number of data rows.
+ * @param col_count Number of columns (usually the header width).
+ * @return true on success, false on allocation failure.
+ */
+bool column_cache_init(ColumnCache* cache, Arena* arena, Row** rows, size_t row_count, size_t col_count);
+
+/**
+ * Returns the parsed vector for a column, parsing it on first use.
+ * @return The column vector, or NULL if the column is out of range or allocation failed.
+ */
+const ColumnVector* column_cache_get(ColumnCache* cache, size_t col);
+
+/**
+ * Returns a column vector whose cells are parsed at least for the block holding `row`.
+ * Values outside that block are only valid if their own block was loaded (or `loaded` is set).
+ * @return The column vector, or NULL if the column/row is out of range or allocation failed.
+ */
+const ColumnVector* column_cache_get_block(ColumnCache* cache, size_t col, size_t row);
+
+/**
+ * Returns the per-block min/max of a column if known, without parsing anything.
+ * Zones are known once the column is fully parsed or after column_cache_set_zones().
+ * @return Array of column_cache_block_count() zones, or NULL.
+ */
+const Zone* column_cache_zones(ColumnCache* cache, size_t col);
+
+/**
+ * Installs a zone map computed elsewhere (e.g. loaded from a sidecar index).
+ * @param zones Array of column_cache_block_count() zones in current row order (copied).
+ * @return true on success, false on allocation failure.
+ */
+bool column_cache_set_zones(ColumnCache* cache, size_t col, const Zone* zones);
+
+/**
+ * Returns the timestamp vector of a column, parsing it on first use.
+ * @return The vector, or NULL if the column is out of range or allocation failed.
+ */
+const TimeVector* column_cache_get_times(ColumnCache* cache, size_t col);
+
+/**
+ * Returns a timestamp vector whose cells are parsed at least for the block holding `row`.
+ * @return The vector, or NULL if the column/row is out of range or allocation failed.
+ */
+const TimeVector* column_cache_get_times_block(ColumnCache* cache, size_t col, size_t row);
+
+/**
+ * Returns the per-block timestamp ranges of a column if known, without parsing anything.
+ * @return Array of column_cache_block_count() ranges, or NULL.
+ */
+const TimeRange* column_cache_time_ranges(ColumnCache* cache, size_t col);
+
+/**
+ * Installs timestamp ranges computed elsewhere (e.g. loaded from a sidecar index).
+ * @return true on success, false on allocation failure.
+ */
+bool column_cache_set_time_ranges(ColumnCache* cache, size_t col, const TimeRange* ranges);
+
+/**
+ * Orders two data rows on a column the way --sort does: blank cells first, then numbers by
+ * value, then other text ignoring ASCII case. The column must be fully parsed.
+ * @return Negative, zero or positive as row `a` sorts before, with or after row `b`.
+ */
+int column_cache_compare(const ColumnCache* cache, size_t col, size_t a, size_t b);
+
+/**
+ * Returns how the cells of a column are ordered (see column_cache_compare()), if known, as
+ * COLUMN_ORDER_* bits; DENSE means every cell is a number. Known once the column is fully
+ * parsed or after column_cache_set_order(); 0 otherwise, without parsing anything.
+ */
+uint8_t column_cache_order(ColumnCache* cache, size_t col);
+
+/**
+ * Returns how the timestamps of a column are ordered, if known, as COLUMN_ORDER_* bits.
+ * ASC and DESC are only reported when every cell is a timestamp (DENSE). Known once the
+ * column is fully parsed as timestamps or after column_cache_set_order(); 0 otherwise.
+ */
+uint8_t column_cache_time_order(ColumnCache* cache, size_t col);
+
+/**
+ * Installs orders computed elsewhere (e.g. loaded from a sidecar index).
+ * @param order Bits for column_cache_order(), or 0 if unknown.
+ * @param time_order Bits for column_cache_time_order(), or 0 if unknown.
+ * @return true on success, false if the column is out of range.
+ */
+bool column_cache_set_order(ColumnCache* cache, size_t col, uint8_t order, uint8_t time_order);
+
+/**
+ * Builds per-block Bloom filters over a column's trimmed cells (ASCII case-folded, as '=' compares).
+ * @return true on success, false on allocation failure.
+ */
+bool column_cache_build_blooms(ColumnCache* cache, size_t col);
+
+/**
+ * Installs Bloom filters computed elsewhere (e.g. loaded from a sidecar index).
+ * @param blooms column_cache_block_count() filters of BLOOM_BLOCK_WORDS words, in current row order (copied).
+ * @return true on success, false on allocation failure.
+ */
+bool column_cache_set_blooms(ColumnCache* cache, size_t col, const uint64_t* blooms);
+
+/**
+ * Returns the per-row field info of a column, measuring the column on first use.
+ * @return Array of row_count entries, or NULL if the column is out of range or allocation failed.
+ */
+const FieldInfo* column_cache_fields(ColumnCache* cache, size_t col);
+
+/**
+ * Returns the column's field info, measured at least for the block holding `row`.
+ * @return Array of row_count entries (only measured blocks are valid), or NULL on error.
+ */
+const FieldInfo* column_cache_fields_block(ColumnCache* cache, size_t col, size_t row);
+
+/**
+ * Measures a single NUL-terminated field (used for cells outside the cache, such as the header).
+ */
+void field_info_compute(const char* text, FieldInfo* info);
+
+/**
+ * Appends a computed numeric column at index cache->col_count. The rows are not widened: the
+ * column's text is formatted from its values when first requested (see column_cache_text()).
+ * The arrays must live in the cache arena; they are adopted, not copied.
+ * @param values row_count values (ignored where `valid` is clear).
+ * @param valid Bitmap of rows holding a value; the other rows are blank.
+ * @return Index of the new column, or (size_t)-1 on allocation failure.
+ */
+size_t column_cache_add_numeric(ColumnCache* cache, double* values, uint64_t* valid);
+
+/**
+ * Reorders the data rows and every loaded vector so that new row `i` is old row `perm[i]`.
+ * `order` is updated so that per-row data saved in file order can still be mapped onto the rows.
+ * @return true on success, false on allocation failure (nothing is changed).
+ */
+bool column_cache_permute(ColumnCache* cache, const size_t* perm);
+
+/**
+ * Returns the number of ZONE_ROWS blocks covering the data rows.
+ */
+static inline size_t column_cache_block_count(const ColumnCache* cache) {
+    return (cache->row_count + ZONE_ROWS - 1) / ZONE_ROWS;
+}
+
+/**
+ * Returns the Bloom filter of the block holding `row`, or NULL if the column has none.
+ */
+static inline const uint64_t* column_cache_bloom(const ColumnCache* cache, size_t col, size_t row) {
+    if (col >= cache->col_count || cache->columns[col].blooms == NULL) {
+        return NULL;
+    }
+    return cache->columns[col].blooms + (row / ZONE_ROWS) * BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * Formats (once) and returns the text of a computed cell; "" where it holds no value.
+ */
+const char* column_cache_computed_text(const ColumnCache* cache, size_t row, size_t col);
+
+/**
+ * Returns the raw text of a cell, or "" if the row has no such field.
+ */
+static inline const char* column_cache_text(const ColumnCache* cache, size_t row, size_t col) {
+    if (col < cache->col_count && cache->columns[col].text != NULL) {
+        return column_cache_computed_text(cache, row, col);
+    }
+
+    const Row* r = cache->rows[row];
+    return (col < r->count && r->fields[col] != NULL) ? r->fields[col] : "";
+}
+
+/**
+ * Reports whether a row has a field in a column; computed columns cover every row.
+ */
+static inline bool column_cache_has_cell(const ColumnCache* cache, size_t row, size_t col) {
+    return col < cache->rows[row]->count || (col < cache->col_count && cache->columns[col].text != NULL);
+}
+
+/**
+ * Returns a field without its surrounding whitespace.
+ * @param text The raw field.
+ * @param info The field's info.
+ * @param len Output: trimmed length.
+ * @return Pointer to the first non-whitespace byte (not NUL-terminated at `len`).
+ */
+static inline const char* field_trimmed(const char* text, const FieldInfo* info, size_t* len) {
+    size_t lead  = info->lead;
+    size_t trail = info->trail;
+
+    if (lead == FIELD_EDGE_MAX || trail == FIELD_EDGE_MAX) {
+        // Rare: long whitespace runs are measured on demand
+        lead = 0;
+        while (lead < info->len && (text[lead] == ' ' || (text[lead] >= '\t' && text[lead] <= '\r'))) lead++;
+        trail = 0;
+        while (trail < info->len - lead &&
+               (text[info->len - 1 - trail] == ' ' ||
+                (text[info->len - 1 - trail] >= '\t' && text[info->len - 1 - trail] <= '\r'))) {
+            trail++;
+        }
+    }
+
+    *len = info->len - lead - trail;
+    return text + lead;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COLUMN_CACHE_H
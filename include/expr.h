@@ -0,0 +1,85 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include <solidc/arena.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "column-cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum rows per expr_eval_batch call; batches must not straddle a ZONE_ROWS block. */
+#define EXPR_BATCH_ROWS 1024
+
+/** Where an instruction reads an operand from. */
+typedef enum {
+    EXPR_REGISTER,  // Result of an earlier instruction
+    EXPR_COLUMN,    // Cached numeric column
+    EXPR_CONSTANT,  // Literal (after constant folding)
+} ExprOperandKind;
+
+/** One instruction input. */
+typedef struct {
+    ExprOperandKind kind;
+    size_t index;     // Register or column index
+    double constant;  // Value of EXPR_CONSTANT operands
+    char* name;       // Column name of EXPR_COLUMN operands, resolved by expr_resolve()
+} ExprOperand;
+
+/** Arithmetic opcodes; unary minus compiles to 0 - x. */
+typedef enum { EXPR_ADD, EXPR_SUB, EXPR_MUL, EXPR_DIV } ExprOpcode;
+
+/** Three-address instruction: registers[target] = lhs op rhs. */
+typedef struct {
+    ExprOpcode op;
+    size_t target;
+    ExprOperand lhs;
+    ExprOperand rhs;
+} ExprInstr;
+
+/**
+ * Compiled arithmetic expression over numeric columns.
+ * The last instruction produces the result; registers are reused in stack order.
+ */
+typedef struct Expr {
+    ExprInstr* code;   // Instructions in evaluation order
+    size_t length;     // Number of instructions (at least one)
+    size_t registers;  // Registers used by the program
+    double* scratch;   // registers * EXPR_BATCH_ROWS values
+    bool resolved;     // Have all column names been resolved?
+} Expr;
+
+/**
+ * Compiles an arithmetic expression such as "price * qty" or "(a - b) / 2".
+ * Supports + - * /, unary minus, parentheses, numeric literals and column names
+ * (double-quote names that contain operator characters or spaces).
+ * @return The program, or NULL if the text is not an expression: a syntax error, a lone
+ *         name or a constant. No error is printed, so callers can fall back to a column lookup.
+ */
+Expr* expr_compile(Arena* arena, const char* text);
+
+/**
+ * Resolves the column names of a compiled expression against the header row.
+ * @return true if every name was found; missing names are reported on stderr.
+ */
+bool expr_resolve(Expr* expr, const Row* header);
+
+/**
+ * Evaluates a resolved expression over rows [start, start + count).
+ * Rows where a referenced cell is not a number, or the result is NaN, are invalid.
+ * @param start First data row (multiple of EXPR_BATCH_ROWS).
+ * @param count Number of rows (at most EXPR_BATCH_ROWS).
+ * @param out Output values, one per row.
+ * @param valid Output bitmap, one bit per row.
+ * @return true on success, false if the expression is unresolved or a column can't be loaded.
+ */
+bool expr_eval_batch(ColumnCache* cache, const Expr* expr, size_t start, size_t count, double* out, uint64_t* valid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // EXPR_H
@@ -0,0 +1,103 @@
+#ifndef HASH_SET_H
+#define HASH_SET_H
+
+#include <solidc/arena.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One occupied slot of the set. */
+typedef struct {
+    uint64_t hash;    // Full hash of the key (0 marks an empty slot)
+    const char* key;  // Key bytes (arena-owned copy)
+    size_t len;       // Key length in bytes
+} StringSetSlot;
+
+/**
+ * Open-addressing (linear probing) set of strings compared case-insensitively (ASCII).
+ * All memory comes from the arena passed to string_set_create().
+ */
+typedef struct StringSet {
+    Arena* arena;
+    StringSetSlot* slots;  // Power-of-two sized table
+    size_t capacity;       // Number of slots
+    size_t count;          // Number of keys stored
+} StringSet;
+
+/**
+ * Hashes `len` bytes after ASCII case folding (FNV-1a, never returns 0).
+ */
+uint64_t hash_bytes_nocase(const char* data, size_t len);
+
+/** Starting value of hash_bytes(). */
+#define HASH_SEED 14695981039346656037ULL
+
+/**
+ * Continues an FNV-1a hash `h` over `len` bytes (start from HASH_SEED). Also names the
+ * cache and index files on disk, so its output must never change.
+ */
+uint64_t hash_bytes(uint64_t h, const void* data, size_t len);
+
+/**
+ * Creates an empty set sized for roughly `expected` keys.
+ * @return The set, or NULL on allocation failure.
+ */
+StringSet* string_set_create(Arena* arena, size_t expected);
+
+/**
+ * Adds a copy of a key to the set (duplicates are ignored).
+ * @return true on success, false on allocation failure.
+ */
+bool string_set_add(StringSet* set, const char* key, size_t len);
+
+/**
+ * Checks whether the set contains a key (ASCII case-insensitive).
+ */
+bool string_set_contains(const StringSet* set, const char* key, size_t len);
+
+/** Tells whether rows `a` and `b` hold the same key. */
+typedef bool (*RowEqualFn)(const void* ctx, size_t a, size_t b);
+
+/** One occupied slot of a row set. */
+typedef struct {
+    uint64_t hash;  // Hash of the row's key (0 marks an empty slot)
+    size_t row;     // Row holding the key
+} RowSetSlot;
+
+/**
+ * Open-addressing (linear probing) set of row keys. Only hashes and row indices are
+ * stored; rows whose hashes match are compared with the caller's RowEqualFn, so hash
+ * collisions never merge different keys. All memory comes from the arena.
+ */
+typedef struct RowSet {
+    Arena* arena;
+    RowSetSlot* slots;  // Power-of-two sized table
+    size_t capacity;    // Number of slots
+    size_t count;       // Number of keys stored
+    RowEqualFn equal;   // Compares the keys of two rows
+    const void* ctx;    // Passed to `equal`
+} RowSet;
+
+/**
+ * Creates an empty row set sized for roughly `expected` keys.
+ * @return The set, or NULL on allocation failure (reported on stderr).
+ */
+RowSet* row_set_create(Arena* arena, size_t expected, RowEqualFn equal, const void* ctx);
+
+/**
+ * Adds the key of `row` unless a row with the same key is already in the set.
+ * @param hash Hash of the row's key.
+ * @param added Output: true if the key was new.
+ * @return true on success, false on allocation failure (reported on stderr).
+ */
+bool row_set_add(RowSet* set, uint64_t hash, size_t row, bool* added);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HASH_SET_H
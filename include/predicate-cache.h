@@ -0,0 +1,37 @@
+#ifndef PREDICATE_CACHE_H
+#define PREDICATE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "column-cache.h"
+#include "sidecar-index.h"
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Suffix of predicate cache entries. */
+#define PREDICATE_CACHE_SUFFIX ".csvqp"
+
+/**
+ * Gives every resolved condition of a where tree a precomputed selection (WhereClause.selection).
+ * Each condition's result over all rows is stored in `dir`, keyed by the file state and the
+ * condition, so a later query that repeats a condition (typically a filter refined one AND
+ * at a time) reads its bitmap instead of scanning the column again. Conditions missing from
+ * the cache are evaluated over every row and saved. Entries are compressed per ZONE_ROWS
+ * block: empty, full, a list of set or clear positions, or a plain bitmap.
+ * Failures are never fatal; the condition is then evaluated as usual.
+ * @param dir Cache directory (created if needed).
+ * @param key File and parse settings of the rows behind `cache`.
+ * @param context Anything else that changes what the columns hold (the --eval definitions), or NULL.
+ * @param root The resolved where tree.
+ */
+void predicate_cache_attach(const char* dir, const SidecarKey* key, const char* context, ColumnCache* cache,
+                            ASTNode* root);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PREDICATE_CACHE_H
@@ -0,0 +1,47 @@
+#ifndef REGEX_DFA_H
+#define REGEX_DFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compiled regular expression matched with a lazily built DFA.
+ *
+ * Supported syntax: literals, '.', [classes] with ranges and negation, escapes
+ * (\d \w \s \D \W \S and escaped metacharacters), groups '(...)' and '(?:...)',
+ * alternation '|', quantifiers '*', '+', '?', '{m}', '{m,}', '{m,n}', and the
+ * anchors '^' and '$'. A leading '(?i)' makes the pattern ASCII case-insensitive.
+ * There is no backtracking, so matching time is linear in the input length.
+ */
+typedef struct Regex Regex;
+
+/**
+ * Compiles a pattern. Errors are reported on stderr.
+ * @param pattern NUL-terminated pattern.
+ * @return The compiled regex, or NULL on error.
+ */
+Regex* regex_compile(const char* pattern);
+
+/**
+ * Checks whether the pattern matches anywhere in `text`.
+ * @param re Compiled regex (its DFA cache is updated, so it is not thread-safe).
+ * @param text Input bytes.
+ * @param len Number of bytes.
+ * @return true if there is a match.
+ */
+bool regex_search(Regex* re, const char* text, size_t len);
+
+/**
+ * Releases a compiled regex.
+ */
+void regex_free(Regex* re);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // REGEX_DFA_H
@@ -0,0 +1,59 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "sidecar-index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Suffix of result cache entries. */
+#define RESULT_CACHE_SUFFIX ".csvqr"
+
+/** State of a query whose stdout is being captured into a cache entry. */
+typedef struct {
+    FILE* file;      // Entry being written (header, then captured output)
+    int saved_fd;    // Original stdout descriptor, restored by result_cache_end()
+    FILE* errors;    // Captured stderr, passed through by result_cache_end()
+    int saved_err;   // Original stderr descriptor, restored by result_cache_end()
+    long data_at;    // Offset of the captured output within `file`
+    char* path;      // Final entry path
+    char* tmp_path;  // Path written until the entry is complete
+} ResultCapture;
+
+/**
+ * Creates the cache directory unless it already exists.
+ * @return true if the directory exists afterwards.
+ */
+bool result_cache_make_dir(const char* dir);
+
+/**
+ * Streams a cached result to stdout if the cache holds one for this file state and query.
+ * @param dir Cache directory.
+ * @param fp Fingerprint of the input file.
+ * @param query Normalized query (every option that affects the output).
+ * @return true if the result was served from the cache.
+ */
+bool result_cache_replay(const char* dir, const FileFingerprint* fp, const char* query);
+
+/**
+ * Starts capturing stdout into a new cache entry, and stderr alongside it. Creates `dir` if needed.
+ * @return true if capturing; false (with a warning) if the query must run uncached.
+ */
+bool result_cache_begin(ResultCapture* cap, const char* dir, const FileFingerprint* fp, const char* query);
+
+/**
+ * Restores stdout and stderr and prints the captured output to them. The entry is kept only if
+ * `success` and nothing was written to stderr, so errors, warnings and notes that a replay would
+ * not repeat never turn into a silently cached result.
+ */
+void result_cache_end(ResultCapture* cap, bool success);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RESULT_CACHE_H
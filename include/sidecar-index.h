@@ -0,0 +1,86 @@
+#ifndef SIDECAR_INDEX_H
+#define SIDECAR_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "column-cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Suffix appended to the CSV path to name its sidecar index. */
+#define SIDECAR_SUFFIX ".csvqi"
+
+/** Cheap identity of a file: an index is only reused while this matches. */
+typedef struct {
+    uint64_t size;         // File size in bytes
+    int64_t mtime;         // Modification time (nanoseconds)
+    uint64_t inode;        // Replaced by editors that write a new file (0 where not available)
+    uint64_t sample_hash;  // Hash of the first and last few KiB
+} FileFingerprint;
+
+/** Everything a sidecar index depends on besides the data itself. */
+typedef struct {
+    FileFingerprint file;  // Source file identity
+    uint64_t row_count;    // Data rows (header excluded)
+    uint64_t col_count;    // Columns covered by the cache
+    uint8_t delimiter;     // Parse settings that change how rows are split
+    uint8_t comment;
+    uint8_t has_header;
+} SidecarKey;
+
+/**
+ * Computes the fingerprint of a file.
+ * @return true on success, false if the file can't be read.
+ */
+bool file_fingerprint(const char* path, FileFingerprint* fp);
+
+/**
+ * Compares two fingerprints field by field.
+ */
+bool file_fingerprint_equal(const FileFingerprint* a, const FileFingerprint* b);
+
+/**
+ * Builds "<dir>/<hash as 16 hex digits><ext><suffix>" in a malloc'd buffer, the name of a cache entry.
+ * The hash only picks the file; readers must still check the key stored in it.
+ * @return The path, or NULL on allocation failure.
+ */
+char* cache_entry_path(const char* dir, uint64_t hash, const char* ext, const char* suffix);
+
+/**
+ * Finishes a file written under `tmp_path`: if `ok`, renames it over `path`, otherwise (or if the
+ * rename fails) removes it. Readers of `path` never see a partially written file.
+ * @return true if `path` now holds the new file.
+ */
+bool replace_file(const char* tmp_path, const char* path, bool ok);
+
+/**
+ * Fills a sidecar key for the file and parse settings behind `cache`.
+ * @return true on success, false if the file can't be fingerprinted.
+ */
+bool sidecar_key_init(SidecarKey* key, const char* csv_path, const ColumnCache* cache, char delimiter, char comment,
+                      bool has_header);
+
+/**
+ * Loads the sidecar index of `csv_path` and installs its data (zone maps, timestamp ranges, Bloom filters,
+ * column orders) into the cache.
+ * Must be called before the rows are reordered.
+ * @return true if an up-to-date index was applied, false if it is missing, stale or unreadable.
+ */
+bool sidecar_load(const char* csv_path, const SidecarKey* key, ColumnCache* cache);
+
+/**
+ * Parses every column, computes the index data and writes the sidecar next to `csv_path`.
+ * Must be called before the rows are reordered. Errors are reported on stderr.
+ * @param bloom_columns col_count flags selecting the columns that get Bloom filters, or NULL for none.
+ * @return true if the index was written.
+ */
+bool sidecar_build(const char* csv_path, const SidecarKey* key, ColumnCache* cache, const bool* bloom_columns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SIDECAR_INDEX_H
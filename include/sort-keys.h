@@ -0,0 +1,107 @@
+#ifndef SORT_KEYS_H
+#define SORT_KEYS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bytes of case-folded text held inline in a text key. */
+#define SORT_KEY_PREFIX 8
+
+/** A data row decorated with its sort key, which is computed once before sorting. */
+typedef struct {
+    uint64_t key;      // sort_key_number() or sort_key_prefix() image of the cell; length of a composite key
+    const char* text;  // Full cell text of text keys (compared only when prefixes tie); bytes of a composite key
+    size_t row;        // Data row index; equal keys keep this order
+} SortKey;
+
+/**
+ * Maps a double to an unsigned integer with the same order (negative numbers included).
+ */
+static inline uint64_t sort_key_number(double value) {
+    if (value == 0) {
+        value = 0;  // -0.0 and 0.0 are equal
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & ((uint64_t)1 << 63)) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+/**
+ * Packs the first SORT_KEY_PREFIX bytes of a text, ASCII case-folded, into a big-endian
+ * integer, so integer order matches strcasecmp() order on the prefix.
+ */
+uint64_t sort_key_prefix(const char* text);
+
+/**
+ * Sorts number keys with an LSD radix sort: one stable counting pass per key byte,
+ * skipping bytes that all keys share. Equal keys keep their row order.
+ * @param keep Number of leading keys that must end up sorted (SIZE_MAX for all). When it is
+ *             small, a bounded heap selects them instead and the rest are left unordered.
+ * @return true on success, false on allocation failure (keys unchanged).
+ */
+bool sort_keys_numbers(SortKey* keys, size_t n, size_t keep, bool desc);
+
+/**
+ * Sorts text keys with an MSD radix sort on the inline prefix. Large groups whose prefixes
+ * tie are bucketed further on the next SORT_KEY_PREFIX bytes of their text, small ones by
+ * strcasecmp() on the rest of the text. Equal keys keep their row order.
+ * @param keep As for sort_keys_numbers().
+ * @return true on success, false on allocation failure (keys unchanged).
+ */
+bool sort_keys_text(SortKey* keys, size_t n, size_t keep, bool desc);
+
+/**
+ * Sets the number of threads every later sort uses, however few keys it has (capped at one
+ * thread per key). 0 restores the default: one per core, each with enough keys to pay off.
+ * Lets tests run the parallel sort and merge on any machine.
+ */
+void sort_keys_set_threads(size_t threads);
+
+/** Bytes sort_key_encode_number() writes. */
+#define SORT_KEY_NUMBER_BYTES 9
+
+/**
+ * Composite keys order rows on several columns at once. Each column is encoded as a tag
+ * (blank < number < text) and its value, all of them appended into one byte string whose
+ * memcmp() order is the row order. Descending columns have their bytes inverted. The
+ * encoding is prefix-free, so comparing the common length of two keys is enough.
+ * A SortKey then holds the string in `text` and its length in `key`.
+ */
+
+/**
+ * Encodes a blank cell into a composite key.
+ * @return Bytes written (1).
+ */
+size_t sort_key_encode_blank(unsigned char* out, bool desc);
+
+/**
+ * Encodes a number into a composite key.
+ * @return Bytes written (SORT_KEY_NUMBER_BYTES).
+ */
+size_t sort_key_encode_number(unsigned char* out, double value, bool desc);
+
+/**
+ * Encodes a text, ASCII case-folded, into a composite key.
+ * @return Bytes written (strlen(text) + 2).
+ */
+size_t sort_key_encode_text(unsigned char* out, const char* text, bool desc);
+
+/**
+ * Sorts composite keys by memcmp() of their bytes. Equal keys keep their row order.
+ * @param keep As for sort_keys_numbers().
+ * @return true on success, false on allocation failure (keys unchanged).
+ */
+bool sort_keys_composite(SortKey* keys, size_t n, size_t keep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SORT_KEYS_H
@@ -0,0 +1,34 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Timestamps are stored as microseconds since 1970-01-01T00:00:00Z. */
+#define TIMESTAMP_PER_SECOND INT64_C(1000000)
+
+/**
+ * Parses an ISO-8601 date or timestamp with a fixed-format parser (no locale, no allocation).
+ *
+ * Accepted forms: "YYYY-MM-DD", optionally followed by 'T' or ' ' and "HH:MM",
+ * "HH:MM:SS" or "HH:MM:SS.ffffff" (up to 6 fraction digits are kept), optionally
+ * followed by 'Z' or an offset "+HH", "+HHMM" or "+HH:MM". Times without an
+ * offset are taken as UTC.
+ *
+ * @param text Input bytes (need not be NUL-terminated).
+ * @param len Number of bytes; the whole span must be a timestamp.
+ * @param out Output: microseconds since the Unix epoch.
+ * @return true if the span is a valid timestamp.
+ */
+bool parse_timestamp(const char* text, size_t len, int64_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TIMESTAMP_H
@@ -2,6 +2,7 @@
 #define TYPES_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,11 +12,15 @@ extern "C" {
 typedef enum {
     OP_CONTAINS,    // case-insensitive substring match
     OP_EQUALS,      // case-insensitive equality
+    OP_EQUALS_CS,   // case-sensitive equality ('==')
     OP_NOT_EQUALS,  // case-insensitive inequality
     OP_GREATER,     // numeric >
     OP_LESS,        // numeric <
     OP_GREATER_EQ,  // numeric >=
     OP_LESS_EQ,     // numeric <=
+    OP_IN,          // case-insensitive membership in a value list
+    OP_MATCHES,     // regular expression search
+    OP_BETWEEN,     // numeric range (inclusive unless a bound is marked exclusive)
 } CompareOp;
 
 /** Logical operators for where clause conditions. */
@@ -24,13 +29,32 @@ typedef enum {
     LOGIC_OR,   // OR operator (at least one condition must match)
 } LogicOp;
 
+struct StringSet;
+struct Regex;
+struct Expr;
+
 /** Where clause filter. */
 typedef struct {
-    char* column_name;  // Column name to filter on
-    size_t column_idx;  // Resolved column index
-    CompareOp op;       // Comparison operator
-    char* value;        // Value to compare against
-    bool is_numeric;    // Whether to treat value as numeric
+    char* column_name;      // Column name to filter on
+    size_t column_idx;      // Resolved column index
+    CompareOp op;           // Comparison operator
+    char* value;            // Value to compare against
+    bool is_numeric;        // Whether to treat value as numeric
+    bool has_number;        // Whether value parsed as a number (numeric ops only)
+    double number;          // Parsed value (lower bound for OP_BETWEEN), computed once at parse time
+    double upper;           // Upper bound for OP_BETWEEN
+    bool exclusive_lower;   // OP_BETWEEN: lower bound excluded (fused from '>')
+    bool exclusive_upper;   // OP_BETWEEN: upper bound excluded (fused from '<')
+    bool is_time;           // Whether value parsed as an ISO-8601 timestamp instead (numeric ops only)
+    int64_t time;           // Parsed timestamp in microseconds (lower bound for OP_BETWEEN)
+    int64_t time_upper;     // Upper timestamp bound for OP_BETWEEN
+    struct StringSet* set;  // Value list for OP_IN
+    struct Regex* regex;    // Compiled pattern for OP_MATCHES
+    struct Expr* expr;      // Arithmetic left-hand side (e.g. "price * qty"), NULL for a plain column
+    uint64_t* selection;    // Precomputed result, one bit per data row (see predicate-cache.h), NULL to evaluate
+    bool has_range;         // Matching rows are exactly [range_start, range_end) (see attach_sorted_ranges())
+    size_t range_start;
+    size_t range_end;
 } WhereClause;
 
 /** AST Node types. */
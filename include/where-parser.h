@@ -7,18 +7,54 @@ extern "C" {
 
 #include <solidc/csvparser.h>
 #include <solidc/arena.h>
+#include "column-cache.h"
 #include "types.h"
 
-bool evaluate_where_filter(const Row* row, const WhereFilter* filter);
+/** Rows evaluated per batch by evaluate_where_batch(). */
+#define WHERE_BATCH_ROWS 1024
+
+/** Bitmap words per batch. */
+#define WHERE_BATCH_WORDS (WHERE_BATCH_ROWS / 64)
+
+/**
+ * Evaluates the where filter over a batch of data rows.
+ * Each condition produces a selection bitmap, combined with AND/OR following the AST.
+ * @param cache Column cache over the data rows.
+ * @param filter The parsed filter (NULL selects every row).
+ * @param start First data row of the batch (multiple of WHERE_BATCH_ROWS).
+ * @param count Number of rows in the batch (at most WHERE_BATCH_ROWS).
+ * @param out Output bitmap of WHERE_BATCH_WORDS words, one bit per batch row.
+ */
+void evaluate_where_batch(ColumnCache* cache, const WhereFilter* filter, size_t start, size_t count, uint64_t* out);
+
+/**
+ * Evaluates a single condition over every data row, in the cache's current row order.
+ * @param out BITMAP_WORDS(cache->row_count) words, one bit per row.
+ */
+void evaluate_clause_all(ColumnCache* cache, const WhereClause* clause, uint64_t* out);
 
 /**
  * Entry point for parsing the where clause.
  */
 bool parse_where_clause(Arena* arena, const char* where_str, WhereFilter* filter);
 
+/**
+ * Releases resources owned by the filter that do not live in the arena (compiled regexes).
+ */
+void free_where_filter(WhereFilter* filter);
+
 // Helper function for Resolving Column Indices (Recursive)
 void resolve_ast_indices(ASTNode* node, const Row* header);
 
+/**
+ * Finds the rows matching range conditions (<, <=, >, >=, BETWEEN) on sorted
+ * columns by binary search, so those conditions are never scanned. Only column orders that
+ * are already known are used (see column_cache_order()), typically from the sidecar index,
+ * and only the blocks holding probed rows are parsed.
+ * The ranges refer to the current row order; call again after reordering the rows.
+ */
+void attach_sorted_ranges(ColumnCache* cache, ASTNode* node);
+
 
 #ifdef __cplusplus
 }
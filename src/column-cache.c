@@ -0,0 +1,896 @@
+#include "../include/column-cache.h"
+#include "../include/ascii-fold.h"
+#include "../include/hash-set.h"
+#include "../include/sort-keys.h"
+#include "../include/timestamp.h"
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Initializes a cache over the data rows.
+ */
+bool column_cache_init(ColumnCache* cache, Arena* arena, Row** rows, size_t row_count, size_t col_count) {
+    if (cache == NULL || arena == NULL) {
+        return false;
+    }
+
+    cache->arena     = arena;
+    cache->rows      = rows;
+    cache->row_count = row_count;
+    cache->col_count = col_count;
+    cache->columns   = NULL;
+    cache->order     = NULL;
+
+    if (col_count > 0) {
+        cache->columns = ARENA_ALLOC_ARRAY(arena, ColumnVector, col_count);
+        if (cache->columns == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed for column cache\n");
+            return false;
+        }
+        memset(cache->columns, 0, sizeof(ColumnVector) * col_count);
+    }
+
+    return true;
+}
+
+/**
+ * Allocates a zeroed bitmap with room for `bits` bits.
+ */
+static uint64_t* alloc_bitmap(Arena* arena, size_t bits) {
+    size_t words  = BITMAP_WORDS(bits);
+    uint64_t* map = ARENA_ALLOC_ARRAY(arena, uint64_t, words > 0 ? words : 1);
+    if (map != NULL) {
+        memset(map, 0, sizeof(uint64_t) * (words > 0 ? words : 1));
+    }
+    return map;
+}
+
+/**
+ * Checks whether `len` bytes form a plain decimal number: [+-]digits[.digits][e[+-]digits].
+ */
+static bool is_decimal(const char* s, size_t len) {
+    size_t i = 0;
+    if (i < len && (s[i] == '+' || s[i] == '-')) i++;
+
+    size_t digits = 0;
+    while (i < len && isdigit((unsigned char)s[i])) i++, digits++;
+    if (i < len && s[i] == '.') {
+        i++;
+        while (i < len && isdigit((unsigned char)s[i])) i++, digits++;
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < len && (s[i] == '+' || s[i] == '-')) i++;
+        size_t exp_digits = 0;
+        while (i < len && isdigit((unsigned char)s[i])) i++, exp_digits++;
+        if (exp_digits == 0) {
+            return false;
+        }
+    }
+
+    return i == len;
+}
+
+/**
+ * Measures a single NUL-terminated field in one pass.
+ */
+void field_info_compute(const char* text, FieldInfo* info) {
+    size_t len   = 0;
+    size_t lead  = 0;
+    size_t trail = 0;
+    bool leading = true;
+    uint8_t flags = 0;
+
+    for (const char* p = text; *p != '\0'; p++, len++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == ' ' || (c >= '\t' && c <= '\r')) {
+            if (leading) lead++;
+            trail++;
+            if (c == '\t' || c == '\n' || c == '\r') flags |= FIELD_HAS_CONTROL;
+            if (c == '\n') flags |= FIELD_NEEDS_QUOTING;
+        } else {
+            leading = false;
+            trail   = 0;
+            if (c == ',' || c == '"') flags |= FIELD_NEEDS_QUOTING;
+        }
+    }
+    if (leading) {
+        trail = 0;  // All-blank field: count the whitespace once, as leading
+    }
+
+    if (lead > 0 || trail > 0) {
+        flags |= FIELD_HAS_EDGE_SPACE;
+    }
+    if (is_decimal(text + lead, len - lead - trail)) {
+        flags |= FIELD_IS_NUMERIC;
+    }
+
+    info->len   = len > UINT32_MAX ? UINT32_MAX : (uint32_t)len;
+    info->lead  = lead > FIELD_EDGE_MAX ? FIELD_EDGE_MAX : (uint8_t)lead;
+    info->trail = trail > FIELD_EDGE_MAX ? FIELD_EDGE_MAX : (uint8_t)trail;
+    info->flags = flags;
+}
+
+/**
+ * Returns the first and one-past-last data row of a block.
+ */
+static inline void block_bounds(const ColumnCache* cache, size_t block, size_t* first, size_t* last) {
+    *first = block * ZONE_ROWS;
+    *last  = *first + ZONE_ROWS < cache->row_count ? *first + ZONE_ROWS : cache->row_count;
+}
+
+/**
+ * Measures the cells of one block into the column's field info.
+ * @return false on allocation failure.
+ */
+static bool measure_block(ColumnCache* cache, size_t col, ColumnVector* vec, size_t block) {
+    if (vec->fields == NULL) {
+        size_t n          = cache->row_count;
+        vec->fields       = ARENA_ALLOC_ARRAY(cache->arena, FieldInfo, n > 0 ? n : 1);
+        vec->field_blocks = alloc_bitmap(cache->arena, column_cache_block_count(cache));
+        if (vec->fields == NULL || vec->field_blocks == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed for field info\n");
+            vec->fields = NULL;
+            return false;
+        }
+    }
+
+    if (!bitmap_test(vec->field_blocks, block)) {
+        size_t first, last;
+        block_bounds(cache, block, &first, &last);
+        for (size_t r = first; r < last; r++) {
+            field_info_compute(column_cache_text(cache, r, col), &vec->fields[r]);
+        }
+        bitmap_set(vec->field_blocks, block);
+    }
+    return true;
+}
+
+/**
+ * Returns the per-row field info of a column, measuring the column on first use.
+ */
+const FieldInfo* column_cache_fields(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    if (vec->fields_complete) {
+        return vec->fields;
+    }
+
+    size_t blocks = column_cache_block_count(cache);
+    for (size_t b = 0; b < blocks; b++) {
+        if (!measure_block(cache, col, vec, b)) {
+            return NULL;
+        }
+    }
+
+    // Empty caches still get a (zero-length) array
+    if (vec->fields == NULL && !measure_block(cache, col, vec, 0)) {
+        return NULL;
+    }
+
+    vec->fields_complete = true;
+    return vec->fields;
+}
+
+/**
+ * Returns the column's field info, measured at least for the block holding `row`.
+ */
+const FieldInfo* column_cache_fields_block(ColumnCache* cache, size_t col, size_t row) {
+    if (cache == NULL || col >= cache->col_count || row >= cache->row_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    if (vec->fields_complete) {
+        return vec->fields;
+    }
+    return measure_block(cache, col, vec, row / ZONE_ROWS) ? vec->fields : NULL;
+}
+
+/**
+ * Parses a trimmed, non-empty span as a number.
+ * @return true if the whole span is a number that fits in a double.
+ */
+static bool parse_number(const char* text, size_t len, double* out) {
+    errno        = 0;
+    char* endptr = NULL;
+    double value = strtod(text, &endptr);
+
+    if (endptr != text + len || errno != 0) {
+        return false;
+    }
+
+    *out = value;
+    return true;
+}
+
+/**
+ * Allocates the arrays of a column vector (cells are parsed block by block later).
+ */
+static bool alloc_vector(ColumnCache* cache, ColumnVector* vec) {
+    size_t n = cache->row_count;
+
+    vec->values        = ARENA_ALLOC_ARRAY(cache->arena, double, n > 0 ? n : 1);
+    vec->numeric       = alloc_bitmap(cache->arena, n);
+    vec->blank         = alloc_bitmap(cache->arena, n);
+    vec->loaded_blocks = alloc_bitmap(cache->arena, column_cache_block_count(cache));
+    if (vec->values == NULL || vec->numeric == NULL || vec->blank == NULL || vec->loaded_blocks == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for column vector\n");
+        vec->values = NULL;
+        return false;
+    }
+
+    vec->numeric_count = 0;
+    vec->blank_count   = 0;
+    return true;
+}
+
+/**
+ * Returns a cell without surrounding whitespace.
+ * Uses the column's field info when its block has been measured, otherwise measures the cell on the spot.
+ */
+static const char* trimmed_cell(const ColumnCache* cache, size_t col, const ColumnVector* vec, bool measured, size_t r,
+                                size_t* len) {
+    const char* raw = column_cache_text(cache, r, col);
+    FieldInfo info;
+    if (measured) {
+        info = vec->fields[r];
+    } else {
+        field_info_compute(raw, &info);
+    }
+    return field_trimmed(raw, &info, len);
+}
+
+/**
+ * Parses the cells of one block into the vector.
+ */
+static void load_block(ColumnCache* cache, size_t col, ColumnVector* vec, size_t block) {
+    size_t first, last;
+    block_bounds(cache, block, &first, &last);
+    bool measured = vec->fields != NULL && bitmap_test(vec->field_blocks, block);
+
+    for (size_t r = first; r < last; r++) {
+        size_t len       = 0;
+        const char* text = trimmed_cell(cache, col, vec, measured, r, &len);
+        double value     = 0.0;
+
+        if (len == 0) {
+            bitmap_set(vec->blank, r);
+            vec->blank_count++;
+        } else if (parse_number(text, len, &value)) {
+            bitmap_set(vec->numeric, r);
+            vec->numeric_count++;
+        } else {
+            value = 0.0;
+        }
+
+        vec->values[r] = value;
+    }
+
+    bitmap_set(vec->loaded_blocks, block);
+}
+
+/**
+ * Parses every remaining block of a column and infers the column type.
+ */
+static bool load_column(ColumnCache* cache, size_t col, ColumnVector* vec) {
+    size_t n = cache->row_count;
+    if (vec->values == NULL && !alloc_vector(cache, vec)) {
+        return false;
+    }
+
+    // Measuring the whole column first lets every block reuse the field info
+    if (column_cache_fields(cache, col) == NULL) {
+        return false;
+    }
+
+    size_t blocks = column_cache_block_count(cache);
+    for (size_t b = 0; b < blocks; b++) {
+        if (!bitmap_test(vec->loaded_blocks, b)) {
+            load_block(cache, col, vec, b);
+        }
+    }
+
+    if (vec->blank_count == n) {
+        vec->type = COLUMN_TYPE_EMPTY;
+    } else if (vec->numeric_count + vec->blank_count == n) {
+        vec->type = COLUMN_TYPE_NUMERIC;
+    } else {
+        vec->type = COLUMN_TYPE_TEXT;
+    }
+
+    vec->loaded = true;
+    return true;
+}
+
+/**
+ * Returns the parsed vector for a column, parsing it on first use.
+ */
+const ColumnVector* column_cache_get(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    if (!vec->loaded && !load_column(cache, col, vec)) {
+        return NULL;
+    }
+    return vec;
+}
+
+/**
+ * Appends a computed numeric column whose text is already in the rows.
+ */
+size_t column_cache_add_numeric(ColumnCache* cache, double* values, uint64_t* valid) {
+    size_t n              = cache->row_count;
+    size_t blocks         = column_cache_block_count(cache);
+    size_t col            = cache->col_count;
+    uint64_t* blank       = alloc_bitmap(cache->arena, n);
+    uint64_t* done        = alloc_bitmap(cache->arena, blocks);
+    char** text           = ARENA_ALLOC_ARRAY(cache->arena, char*, n > 0 ? n : 1);
+    ColumnVector* columns = ARENA_ALLOC_ARRAY(cache->arena, ColumnVector, col + 1);
+    if (blank == NULL || done == NULL || text == NULL || columns == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for computed column\n");
+        return (size_t)-1;
+    }
+
+    if (col > 0) {
+        memcpy(columns, cache->columns, sizeof(ColumnVector) * col);
+    }
+    ColumnVector* vec = &columns[col];
+    memset(vec, 0, sizeof(*vec));
+
+    memset(text, 0, sizeof(char*) * n);
+
+    vec->values        = values;
+    vec->numeric       = valid;
+    vec->blank         = blank;
+    vec->loaded_blocks = done;
+    vec->text          = text;
+    for (size_t r = 0; r < n; r++) {
+        if (bitmap_test(valid, r)) {
+            vec->numeric_count++;
+        } else {
+            bitmap_set(blank, r);
+            vec->values[r] = 0.0;
+        }
+    }
+    for (size_t b = 0; b < blocks; b++) {
+        bitmap_set(done, b);
+    }
+
+    vec->blank_count = n - vec->numeric_count;
+    vec->type        = vec->numeric_count > 0 ? COLUMN_TYPE_NUMERIC : COLUMN_TYPE_EMPTY;
+    vec->loaded      = true;
+
+    cache->columns = columns;
+    cache->col_count++;
+    return col;
+}
+
+/**
+ * Formats a computed cell on first request and keeps the text for later calls.
+ */
+const char* column_cache_computed_text(const ColumnCache* cache, size_t row, size_t col) {
+    ColumnVector* vec = &cache->columns[col];
+    if (vec->text[row] != NULL || !bitmap_test(vec->numeric, row)) {
+        return vec->text[row] != NULL ? vec->text[row] : "";
+    }
+
+    char buf[32];
+    int len    = snprintf(buf, sizeof(buf), "%.15g", vec->values[row]);
+    char* text = arena_alloc(cache->arena, (size_t)len + 1);
+    if (text == NULL) {
+        return "";
+    }
+    memcpy(text, buf, (size_t)len + 1);
+    vec->text[row] = text;
+    return text;
+}
+
+/**
+ * Returns a column vector whose cells are parsed at least for the block holding `row`.
+ */
+const ColumnVector* column_cache_get_block(ColumnCache* cache, size_t col, size_t row) {
+    if (cache == NULL || col >= cache->col_count || row >= cache->row_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    if (vec->loaded) {
+        return vec;
+    }
+    if (vec->values == NULL && !alloc_vector(cache, vec)) {
+        return NULL;
+    }
+
+    size_t block = row / ZONE_ROWS;
+    if (!bitmap_test(vec->loaded_blocks, block)) {
+        load_block(cache, col, vec, block);
+    }
+    return vec;
+}
+
+/**
+ * Returns the per-block min/max of a column if known, without parsing anything.
+ */
+const Zone* column_cache_zones(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    if (vec->zones != NULL || !vec->loaded) {
+        return vec->zones;
+    }
+
+    // A fully parsed column gets its zone map for free
+    size_t blocks = column_cache_block_count(cache);
+    Zone* zones   = ARENA_ALLOC_ARRAY(cache->arena, Zone, blocks > 0 ? blocks : 1);
+    if (zones == NULL) {
+        return NULL;  // Not fatal: blocks just can't be skipped
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+        size_t first, last;
+        block_bounds(cache, b, &first, &last);
+
+        zones[b].min = INFINITY;
+        zones[b].max = -INFINITY;
+        for (size_t r = first; r < last; r++) {
+            double v = vec->values[r];
+            // NaN never satisfies a comparison, so it does not widen the zone
+            if (bitmap_test(vec->numeric, r) && v == v) {
+                if (v < zones[b].min) zones[b].min = v;
+                if (v > zones[b].max) zones[b].max = v;
+            }
+        }
+    }
+
+    vec->zones = zones;
+    return zones;
+}
+
+/**
+ * Installs a zone map computed elsewhere (e.g. loaded from a sidecar index).
+ */
+bool column_cache_set_zones(ColumnCache* cache, size_t col, const Zone* zones) {
+    if (cache == NULL || col >= cache->col_count || zones == NULL) {
+        return false;
+    }
+
+    size_t blocks = column_cache_block_count(cache);
+    Zone* copy    = ARENA_ALLOC_ARRAY(cache->arena, Zone, blocks > 0 ? blocks : 1);
+    if (copy == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for zone map\n");
+        return false;
+    }
+
+    memcpy(copy, zones, sizeof(Zone) * blocks);
+    cache->columns[col].zones = copy;
+    return true;
+}
+
+/**
+ * Parses the cells of one block as timestamps.
+ */
+static void load_time_block(ColumnCache* cache, size_t col, ColumnVector* vec, size_t block) {
+    TimeVector* tv = &vec->times;
+    size_t first, last;
+    block_bounds(cache, block, &first, &last);
+    bool measured = vec->fields != NULL && bitmap_test(vec->field_blocks, block);
+
+    for (size_t r = first; r < last; r++) {
+        size_t len       = 0;
+        const char* text = trimmed_cell(cache, col, vec, measured, r, &len);
+        int64_t value    = 0;
+
+        if (len > 0 && parse_timestamp(text, len, &value)) {
+            bitmap_set(tv->valid, r);
+            tv->valid_count++;
+        } else {
+            value = 0;
+        }
+        tv->values[r] = value;
+    }
+
+    bitmap_set(tv->loaded_blocks, block);
+}
+
+/**
+ * Allocates the arrays of a column's timestamp vector.
+ */
+static bool alloc_times(ColumnCache* cache, TimeVector* tv) {
+    size_t n = cache->row_count;
+
+    tv->values        = ARENA_ALLOC_ARRAY(cache->arena, int64_t, n > 0 ? n : 1);
+    tv->valid         = alloc_bitmap(cache->arena, n);
+    tv->loaded_blocks = alloc_bitmap(cache->arena, column_cache_block_count(cache));
+    if (tv->values == NULL || tv->valid == NULL || tv->loaded_blocks == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for timestamp vector\n");
+        tv->values = NULL;
+        return false;
+    }
+
+    tv->valid_count = 0;
+    return true;
+}
+
+/**
+ * Returns the timestamp vector of a column, parsing every block on first use.
+ */
+const TimeVector* column_cache_get_times(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    TimeVector* tv    = &vec->times;
+    if (tv->loaded) {
+        return tv;
+    }
+    if (tv->values == NULL && !alloc_times(cache, tv)) {
+        return NULL;
+    }
+
+    size_t blocks = column_cache_block_count(cache);
+    for (size_t b = 0; b < blocks; b++) {
+        if (!bitmap_test(tv->loaded_blocks, b)) {
+            load_time_block(cache, col, vec, b);
+        }
+    }
+
+    tv->loaded = true;
+    return tv;
+}
+
+/**
+ * Returns a timestamp vector whose cells are parsed at least for the block holding `row`.
+ */
+const TimeVector* column_cache_get_times_block(ColumnCache* cache, size_t col, size_t row) {
+    if (cache == NULL || col >= cache->col_count || row >= cache->row_count) {
+        return NULL;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    TimeVector* tv    = &vec->times;
+    if (tv->loaded) {
+        return tv;
+    }
+    if (tv->values == NULL && !alloc_times(cache, tv)) {
+        return NULL;
+    }
+
+    size_t block = row / ZONE_ROWS;
+    if (!bitmap_test(tv->loaded_blocks, block)) {
+        load_time_block(cache, col, vec, block);
+    }
+    return tv;
+}
+
+/**
+ * Returns the per-block timestamp ranges of a column if known, without parsing anything.
+ */
+const TimeRange* column_cache_time_ranges(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return NULL;
+    }
+
+    TimeVector* tv = &cache->columns[col].times;
+    if (tv->ranges != NULL || !tv->loaded) {
+        return tv->ranges;
+    }
+
+    size_t blocks     = column_cache_block_count(cache);
+    TimeRange* ranges = ARENA_ALLOC_ARRAY(cache->arena, TimeRange, blocks > 0 ? blocks : 1);
+    if (ranges == NULL) {
+        return NULL;  // Not fatal: blocks just can't be skipped
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+        size_t first, last;
+        block_bounds(cache, b, &first, &last);
+
+        ranges[b].min = INT64_MAX;
+        ranges[b].max = INT64_MIN;
+        for (size_t r = first; r < last; r++) {
+            if (bitmap_test(tv->valid, r)) {
+                if (tv->values[r] < ranges[b].min) ranges[b].min = tv->values[r];
+                if (tv->values[r] > ranges[b].max) ranges[b].max = tv->values[r];
+            }
+        }
+    }
+
+    tv->ranges = ranges;
+    return ranges;
+}
+
+/**
+ * Installs timestamp ranges computed elsewhere (e.g. loaded from a sidecar index).
+ */
+bool column_cache_set_time_ranges(ColumnCache* cache, size_t col, const TimeRange* ranges) {
+    if (cache == NULL || col >= cache->col_count || ranges == NULL) {
+        return false;
+    }
+
+    size_t blocks   = column_cache_block_count(cache);
+    TimeRange* copy = ARENA_ALLOC_ARRAY(cache->arena, TimeRange, blocks > 0 ? blocks : 1);
+    if (copy == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for timestamp ranges\n");
+        return false;
+    }
+
+    memcpy(copy, ranges, sizeof(TimeRange) * blocks);
+    cache->columns[col].times.ranges = copy;
+    return true;
+}
+
+/**
+ * Orders two data rows on a fully parsed column, as --sort does.
+ */
+int column_cache_compare(const ColumnCache* cache, size_t col, size_t a, size_t b) {
+    const ColumnVector* vec = &cache->columns[col];
+
+    // Blank, number, text
+    int rank_a = bitmap_test(vec->blank, a) ? 0 : bitmap_test(vec->numeric, a) ? 1 : 2;
+    int rank_b = bitmap_test(vec->blank, b) ? 0 : bitmap_test(vec->numeric, b) ? 1 : 2;
+    if (rank_a != rank_b || rank_a == 0) {
+        return rank_a - rank_b;
+    }
+
+    if (rank_a == 1) {
+        uint64_t x = sort_key_number(vec->values[a]);
+        uint64_t y = sort_key_number(vec->values[b]);
+        return (x > y) - (x < y);
+    }
+    return ascii_compare_nocase(column_cache_text(cache, a, col), column_cache_text(cache, b, col));
+}
+
+/**
+ * Returns how the cells of a column are ordered, computing it for a fully parsed column.
+ */
+uint8_t column_cache_order(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return 0;
+    }
+
+    ColumnVector* vec = &cache->columns[col];
+    if ((vec->order & COLUMN_ORDER_KNOWN) || !vec->loaded) {
+        return vec->order;
+    }
+
+    // One pass, stopping as soon as neither direction holds
+    bool asc  = true;
+    bool desc = true;
+    for (size_t r = 1; r < cache->row_count && (asc || desc); r++) {
+        int cmp = column_cache_compare(cache, col, r - 1, r);
+        asc     = asc && cmp <= 0;
+        desc    = desc && cmp >= 0;
+    }
+
+    bool dense = (asc || desc) && vec->numeric_count == cache->row_count;
+    for (size_t r = 0; dense && r < cache->row_count; r++) {
+        dense = vec->values[r] == vec->values[r];  // NaN matches no range
+    }
+
+    vec->order = COLUMN_ORDER_KNOWN | (asc ? COLUMN_ORDER_ASC : 0) | (desc ? COLUMN_ORDER_DESC : 0) |
+                 (dense ? COLUMN_ORDER_DENSE : 0);
+    return vec->order;
+}
+
+/**
+ * Returns how the timestamps of a column are ordered, computing it for a fully parsed column.
+ */
+uint8_t column_cache_time_order(ColumnCache* cache, size_t col) {
+    if (cache == NULL || col >= cache->col_count) {
+        return 0;
+    }
+
+    TimeVector* tv = &cache->columns[col].times;
+    if ((tv->order & COLUMN_ORDER_KNOWN) || !tv->loaded) {
+        return tv->order;
+    }
+
+    bool dense = tv->valid_count == cache->row_count;
+    bool asc   = dense;
+    bool desc  = dense;
+    for (size_t r = 1; r < cache->row_count && (asc || desc); r++) {
+        asc  = asc && tv->values[r - 1] <= tv->values[r];
+        desc = desc && tv->values[r - 1] >= tv->values[r];
+    }
+
+    tv->order = COLUMN_ORDER_KNOWN | (asc ? COLUMN_ORDER_ASC : 0) | (desc ? COLUMN_ORDER_DESC : 0) |
+                (dense ? COLUMN_ORDER_DENSE : 0);
+    return tv->order;
+}
+
+/**
+ * Installs orders computed elsewhere (e.g. loaded from a sidecar index).
+ */
+bool column_cache_set_order(ColumnCache* cache, size_t col, uint8_t order, uint8_t time_order) {
+    if (cache == NULL || col >= cache->col_count) {
+        return false;
+    }
+
+    cache->columns[col].order       = order;
+    cache->columns[col].times.order = time_order;
+    return true;
+}
+
+/**
+ * Builds per-block Bloom filters over a column's trimmed cells.
+ */
+bool column_cache_build_blooms(ColumnCache* cache, size_t col) {
+    const FieldInfo* fields = column_cache_fields(cache, col);
+    if (fields == NULL) {
+        return false;
+    }
+
+    size_t blocks    = column_cache_block_count(cache);
+    uint64_t* blooms = ARENA_ALLOC_ARRAY(cache->arena, uint64_t, (blocks > 0 ? blocks : 1) * BLOOM_BLOCK_WORDS);
+    if (blooms == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for Bloom filters\n");
+        return false;
+    }
+    memset(blooms, 0, sizeof(uint64_t) * (blocks > 0 ? blocks : 1) * BLOOM_BLOCK_WORDS);
+
+    for (size_t r = 0; r < cache->row_count; r++) {
+        size_t len       = 0;
+        const char* text = field_trimmed(column_cache_text(cache, r, col), &fields[r], &len);
+        bloom_add(blooms + (r / ZONE_ROWS) * BLOOM_BLOCK_WORDS, hash_bytes_nocase(text, len));
+    }
+
+    cache->columns[col].blooms = blooms;
+    return true;
+}
+
+/**
+ * Installs Bloom filters computed elsewhere (e.g. loaded from a sidecar index).
+ */
+bool column_cache_set_blooms(ColumnCache* cache, size_t col, const uint64_t* blooms) {
+    if (cache == NULL || col >= cache->col_count || blooms == NULL) {
+        return false;
+    }
+
+    size_t words   = column_cache_block_count(cache) * BLOOM_BLOCK_WORDS;
+    uint64_t* copy = ARENA_ALLOC_ARRAY(cache->arena, uint64_t, words > 0 ? words : 1);
+    if (copy == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for Bloom filters\n");
+        return false;
+    }
+
+    memcpy(copy, blooms, sizeof(uint64_t) * words);
+    cache->columns[col].blooms = copy;
+    return true;
+}
+
+/**
+ * Reorders a bitmap in place according to `perm`, using `scratch` as temporary storage.
+ */
+static void permute_bitmap(uint64_t* bits, uint64_t* scratch, const size_t* perm, size_t n) {
+    memset(scratch, 0, sizeof(uint64_t) * BITMAP_WORDS(n));
+    for (size_t i = 0; i < n; i++) {
+        if (bitmap_test(bits, perm[i])) {
+            bitmap_set(scratch, i);
+        }
+    }
+    memcpy(bits, scratch, sizeof(uint64_t) * BITMAP_WORDS(n));
+}
+
+/**
+ * Reorders the data rows and every loaded vector so that new row `i` is old row `perm[i]`.
+ */
+bool column_cache_permute(ColumnCache* cache, const size_t* perm) {
+    size_t n = cache->row_count;
+    if (n < 2) {
+        return true;
+    }
+
+    // One scratch buffer large enough for any of rows, positions, values, field info or bitmaps.
+    size_t elem_size    = sizeof(Row*) > sizeof(double) ? sizeof(Row*) : sizeof(double);
+    size_t scratch_size = n * (elem_size > sizeof(FieldInfo) ? elem_size : sizeof(FieldInfo));
+    void* scratch       = malloc(scratch_size);
+    if (scratch == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed while reordering rows\n");
+        return false;
+    }
+
+    size_t* order = cache->order != NULL ? cache->order : ARENA_ALLOC_ARRAY(cache->arena, size_t, n);
+    if (order == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed while reordering rows\n");
+        free(scratch);
+        return false;
+    }
+
+    size_t* from = scratch;
+    for (size_t i = 0; i < n; i++) {
+        from[i] = cache->order != NULL ? cache->order[perm[i]] : perm[i];
+    }
+    memcpy(order, from, sizeof(size_t) * n);
+    cache->order = order;
+
+    Row** rows = scratch;
+    for (size_t i = 0; i < n; i++) {
+        rows[i] = cache->rows[perm[i]];
+    }
+    memcpy(cache->rows, rows, sizeof(Row*) * n);
+
+    for (size_t c = 0; c < cache->col_count; c++) {
+        ColumnVector* vec = &cache->columns[c];
+        if (vec->fields_complete) {
+            FieldInfo* fields = scratch;
+            for (size_t i = 0; i < n; i++) {
+                fields[i] = vec->fields[perm[i]];
+            }
+            memcpy(vec->fields, fields, sizeof(FieldInfo) * n);
+        } else if (vec->fields != NULL) {
+            // Partially measured columns are measured again in the new order
+            memset(vec->field_blocks, 0, sizeof(uint64_t) * BITMAP_WORDS(column_cache_block_count(cache)));
+        }
+
+        // Zones, Bloom filters and orders describe row positions, so they no longer apply.
+        // Zones and orders are rebuilt on demand; Bloom filters are only built on request.
+        vec->zones        = NULL;
+        vec->blooms       = NULL;
+        vec->times.ranges = NULL;
+        vec->order        = 0;
+        vec->times.order  = 0;
+
+        if (vec->text != NULL) {
+            char** text = scratch;
+            for (size_t i = 0; i < n; i++) {
+                text[i] = vec->text[perm[i]];
+            }
+            memcpy(vec->text, text, sizeof(char*) * n);
+        }
+
+        TimeVector* tv = &vec->times;
+        if (tv->loaded) {
+            int64_t* times = scratch;
+            for (size_t i = 0; i < n; i++) {
+                times[i] = tv->values[perm[i]];
+            }
+            memcpy(tv->values, times, sizeof(int64_t) * n);
+            permute_bitmap(tv->valid, scratch, perm, n);
+        } else if (tv->values != NULL) {
+            memset(tv->valid, 0, sizeof(uint64_t) * BITMAP_WORDS(n));
+            memset(tv->loaded_blocks, 0, sizeof(uint64_t) * BITMAP_WORDS(column_cache_block_count(cache)));
+            tv->valid_count = 0;
+        }
+
+        if (!vec->loaded) {
+            // Partially parsed columns are simply parsed again, block by block, in the new order
+            if (vec->values != NULL) {
+                memset(vec->numeric, 0, sizeof(uint64_t) * BITMAP_WORDS(n));
+                memset(vec->blank, 0, sizeof(uint64_t) * BITMAP_WORDS(n));
+                memset(vec->loaded_blocks, 0, sizeof(uint64_t) * BITMAP_WORDS(column_cache_block_count(cache)));
+                vec->numeric_count = 0;
+                vec->blank_count   = 0;
+            }
+            continue;
+        }
+
+        double* values = scratch;
+        for (size_t i = 0; i < n; i++) {
+            values[i] = vec->values[perm[i]];
+        }
+        memcpy(vec->values, values, sizeof(double) * n);
+
+        permute_bitmap(vec->numeric, scratch, perm, n);
+        permute_bitmap(vec->blank, scratch, perm, n);
+    }
+
+    free(scratch);
+    return true;
+}
@@ -15,13 +15,19 @@
 #include <solidc/csvparser.h>    // CSV parsing functions
 #include <solidc/flags.h>        // Command-line parser
 #include <solidc/prettytable.h>  // Table printer
-#include <solidc/str_utils.h>    // trim_string
 #include <stdbool.h>             // for bool
 #include <stdint.h>              // for SIZE_MAX
 #include <stdio.h>               // for fprintf, printf, stderr
 #include <stdlib.h>              // for EXIT_FAILURE, EXIT_SUCCESS, malloc, free, calloc
 #include <string.h>              // for strlen, strcasestr, strcmp, strdup
 #include <strings.h>             // for strcasecmp
+#include "../include/ascii-fold.h"
+#include "../include/expr.h"
+#include "../include/hash-set.h"
+#include "../include/predicate-cache.h"
+#include "../include/result-cache.h"
+#include "../include/sort-keys.h"
+#include "../include/sidecar-index.h"
 #include "../include/where-parser.h"
 
 // =============================================================================
@@ -37,6 +43,9 @@
 /** Maximum number of columns we support selecting/reordering. */
 #define MAX_SELECTED_COLUMNS 64
 
+/** Maximum number of sort keys in --sort. */
+#define MAX_SORT_KEYS 16
+
 /** ANSI color codes for column coloring. */
 static const char* COLUMN_COLORS[] = {
     "\033[36m",  // Cyan
@@ -80,16 +89,24 @@ typedef struct {
     size_t count;                          // Number of selected columns
 } ColumnSelection;
 
-/** Context for the qsort comparison function. */
+/** How the cells of a sort key compare. */
+typedef enum {
+    SORT_AUTO,     // Blanks, then numbers by value, then text (default)
+    SORT_NUMERIC,  // Numbers by value; other cells sort as blanks (":num")
+    SORT_TEXT,     // Every non-blank cell as text, numbers included (":text")
+} SortType;
+
+/** One key of a --sort list, such as "-revenue" or "zip:text". */
 typedef struct {
-    size_t col_idx;  // Index of column to sort by
-    bool desc;       // Sort descending?
-    bool active;     // Is sorting active?
-} SortContext;
+    size_t col;     // Column index
+    bool desc;      // Descending ("-" prefix, flipped by --desc)
+    SortType type;  // How cells compare
+} SortField;
 
 /** Context for table rendering callbacks. */
 typedef struct {
-    Row** rows;
+    ColumnCache* cache;      // Data rows and their field info
+    const size_t* row_idx;   // Cache row of each table row
     size_t* col_mapping;
     size_t* widths;  // Pre-computed widths for manual padding when using colors
     bool use_colors;
@@ -97,6 +114,14 @@ typedef struct {
     const Row* header;  // Original header row for get_header
 } TableContext;
 
+/** Which rows --distinct and --unique-by keep. */
+typedef struct {
+    ColumnCache* cache;  // Rows to compare
+    const size_t* cols;  // Columns whose cells together identify a row
+    size_t col_count;    // Number of columns in `cols`
+    bool keep_last;      // Keep the last row of each key instead of the first
+} UniqueRows;
+
 /** Configuration for printing operations. */
 typedef struct {
     bool has_header;
@@ -106,6 +131,9 @@ typedef struct {
     const char* filter_pattern;
     WhereFilter* where;
     const ColumnSelection* selection;
+    const UniqueRows* unique;  // Duplicate rows to drop before sorting, or NULL
+    const char* sort;          // Sort keys for the surviving rows, or NULL
+    bool sort_desc;            // Reverse every sort key
     size_t limit;
     size_t offset;
 } PrintConfig;
@@ -142,15 +170,14 @@ typedef struct {
  */
 static unsigned long hidden_columns_mask = 0;
 
-/** Context for the qsort comparison function. */
-static SortContext sort_ctx = {0, false, false};
-
 // Forward declarations for helpers defined later in this file.
 static int build_column_mapping(Arena* arena, size_t original_col_count, const ColumnSelection* selection,
                                 size_t** col_mapping);
-static size_t filter_rows(Arena* arena, Row** rows, size_t row_count, bool has_header, const char* filter_pattern,
-                          WhereFilter* where, Row*** filtered_rows);
-static bool row_passes_filters(const Row* row, const char* filter_pattern, WhereFilter* where);
+static size_t filter_rows(Arena* arena, ColumnCache* cache, const char* filter_pattern, WhereFilter* where,
+                          size_t** filtered_idx);
+static void select_rows_batch(ColumnCache* cache, size_t start, size_t count, const char* filter_pattern,
+                              WhereFilter* where, uint64_t* selected);
+static bool unique_rows(Arena* arena, const UniqueRows* unique, size_t* rows, size_t* count);
 static void print_describe_pretty_table(const char** headers, const char** cells, size_t num_rows, size_t num_cols,
                                         bool use_colors, Arena* arena);
 
@@ -336,41 +363,26 @@ static bool parse_column_selection(const char* select_str, const Row* header, Co
 
 /**
  * Checks if a row matches the given filter pattern (case-insensitive substring).
- * @param row The row to check.
+ * @param cache Column cache over the data rows; computed columns are searched too.
+ * @param r Cache index of the row to check.
  * @param pattern The pattern to search for.
  * @return true if the row contains the pattern in any field, false otherwise.
  */
-static bool row_matches_filter(const Row* row, const char* pattern) {
+static bool row_matches_filter(const ColumnCache* cache, size_t r, const char* pattern) {
     if (pattern == NULL || pattern[0] == '\0') {
         return true;
     }
 
-    for (size_t i = 0; i < row->count; i++) {
-        if (row->fields[i] != NULL && strcasestr(row->fields[i], pattern) != NULL) {
+    const Row* row = cache->rows[r];
+    size_t width   = row->count > cache->col_count ? row->count : cache->col_count;
+    for (size_t i = 0; i < width; i++) {
+        if (strcasestr(column_cache_text(cache, r, i), pattern) != NULL) {
             return true;
         }
     }
     return false;
 }
 
-/**
- * Checks whether a string is blank (NULL, empty, or only whitespace).
- */
-static bool is_blank_field(const char* s) {
-    if (s == NULL) {
-        return true;
-    }
-
-    while (*s != '\0') {
-        if (!isspace((unsigned char)*s)) {
-            return false;
-        }
-        s++;
-    }
-
-    return true;
-}
-
 /**
  * Parses a non-negative integer command-line option.
  */
@@ -425,25 +437,43 @@ static void compute_row_window(size_t filtered_count, size_t offset, size_t limi
 /**
  * Counts rows that satisfy active filters.
  */
-static size_t count_filtered_rows(Row** rows, size_t row_count, bool has_header, const char* filter_pattern,
-                                  WhereFilter* where) {
-    size_t start_row = (has_header && row_count > 0) ? 1 : 0;
-    size_t matched   = 0;
+static size_t count_filtered_rows(ColumnCache* cache, const char* filter_pattern, WhereFilter* where) {
+    size_t matched = 0;
+    uint64_t selected[WHERE_BATCH_WORDS];
+
+    for (size_t start = 0; start < cache->row_count; start += WHERE_BATCH_ROWS) {
+        size_t n = cache->row_count - start < WHERE_BATCH_ROWS ? cache->row_count - start : WHERE_BATCH_ROWS;
+        select_rows_batch(cache, start, n, filter_pattern, where, selected);
 
-    for (size_t i = start_row; i < row_count; i++) {
-        if (row_passes_filters(rows[i], filter_pattern, where)) {
-            matched++;
+        for (size_t w = 0; w < BITMAP_WORDS(n); w++) {
+            matched += bitmap_popcount(selected[w]);
         }
     }
 
     return matched;
 }
 
+/**
+ * Counts rows that satisfy active filters, each key once.
+ * @return true on success, false on allocation failure (reported on stderr).
+ */
+static bool count_unique_rows(Arena* arena, ColumnCache* cache, const char* filter_pattern, WhereFilter* where,
+                              const UniqueRows* unique, size_t* matched) {
+    size_t* filtered_idx = NULL;
+    *matched             = filter_rows(arena, cache, filter_pattern, where, &filtered_idx);
+    if (filtered_idx == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for row list\n");
+        return false;
+    }
+    return unique_rows(arena, unique, filtered_idx, matched);
+}
+
 /**
  * Prints numeric descriptive statistics for visible columns.
  */
-static void print_describe_stats(Row** rows, size_t row_count, bool has_header, const char* filter_pattern,
-                                 WhereFilter* where, const ColumnSelection* selection, bool use_colors) {
+static void print_describe_stats(Row** rows, size_t row_count, bool has_header, ColumnCache* cache,
+                                 const char* filter_pattern, WhereFilter* where, const UniqueRows* unique,
+                                 const ColumnSelection* selection, bool use_colors) {
     if (row_count == 0 || rows[0]->count == 0) {
         fprintf(stderr, "Error: No data to describe\n");
         return;
@@ -467,8 +497,12 @@ static void print_describe_stats(Row** rows, size_t row_count, bool has_header,
         return;
     }
 
-    Row** filtered_rows   = NULL;
-    size_t filtered_count = filter_rows(arena, rows, row_count, has_header, filter_pattern, where, &filtered_rows);
+    size_t* filtered_idx  = NULL;
+    size_t filtered_count = filter_rows(arena, cache, filter_pattern, where, &filtered_idx);
+    if (unique != NULL && !unique_rows(arena, unique, filtered_idx, &filtered_count)) {
+        arena_destroy(arena);
+        return;
+    }
 
     const size_t describe_cols     = 7;
     const char* describe_headers[] = {"Column", "Numeric", "Missing", "NonNumeric", "Min", "Max", "Mean"};
@@ -484,26 +518,19 @@ static void print_describe_stats(Row** rows, size_t row_count, bool has_header,
     for (int i = 0; i < visible_cols; i++) {
         size_t col = col_mapping[i];
 
-        ColumnStats stats = {0};
+        ColumnStats stats       = {0};
+        const ColumnVector* vec = column_cache_get(cache, col);
 
         for (size_t r = 0; r < filtered_count; r++) {
-            Row* row          = filtered_rows[r];
-            const char* field = (col < row->count && row->fields[col] != NULL) ? row->fields[col] : NULL;
+            size_t row_idx = filtered_idx[r];
 
-            if (is_blank_field(field)) {
+            if (vec == NULL || bitmap_test(vec->blank, row_idx)) {
                 stats.missing_count++;
                 continue;
             }
 
-            errno        = 0;
-            char* endptr = NULL;
-            double value = strtod(field, &endptr);
-
-            while (endptr != NULL && isspace((unsigned char)*endptr)) {
-                endptr++;
-            }
-
-            if (endptr != NULL && *endptr == '\0' && errno == 0) {
+            if (bitmap_test(vec->numeric, row_idx)) {
+                double value = vec->values[row_idx];
                 if (!stats.has_numeric) {
                     stats.min         = value;
                     stats.max         = value;
@@ -570,132 +597,519 @@ static void print_describe_stats(Row** rows, size_t row_count, bool has_header,
 }
 
 /**
- * Applies all filters to a row.
- * @param row The row to check.
+ * Applies all filters to a batch of data rows.
+ * @param cache Column cache over the data rows.
+ * @param start First data row of the batch (multiple of WHERE_BATCH_ROWS).
+ * @param count Number of rows in the batch.
  * @param filter_pattern Optional substring filter.
  * @param where Optional WHERE clause filter.
- * @return true if the row passes all filters.
+ * @param selected Output bitmap with one bit set per row that passes all filters.
+ */
+static void select_rows_batch(ColumnCache* cache, size_t start, size_t count, const char* filter_pattern,
+                              WhereFilter* where, uint64_t* selected) {
+    evaluate_where_batch(cache, where, start, count, selected);
+
+    if (filter_pattern == NULL || filter_pattern[0] == '\0') {
+        return;
+    }
+
+    // The substring filter only runs on rows the where clause kept
+    for (size_t w = 0; w < BITMAP_WORDS(count); w++) {
+        uint64_t pending = selected[w];
+        while (pending != 0) {
+            unsigned j = bitmap_lowest(pending);
+            pending &= pending - 1;
+
+            if (!row_matches_filter(cache, start + w * 64 + j, filter_pattern)) {
+                selected[w] &= ~((uint64_t)1 << j);
+            }
+        }
+    }
+}
+
+// =============================================================================
+// SORTING
+// =============================================================================
+
+/**
+ * Computes the sort keys of a list of data rows from the cached column, keeping list order:
+ * number cells first, then other non-blank cells. Blank cells get no key.
+ * @param vec The parsed sort column, or NULL if the rows have no such column.
+ * @param num_count Output: number keys written at the start of `keys`.
+ * @param text_count Output: text keys written after them.
+ */
+static void decorate_rows(const ColumnCache* cache, const ColumnVector* vec, size_t col, const size_t* rows,
+                          size_t count, SortKey* keys, size_t* num_count, size_t* text_count) {
+    *num_count  = 0;
+    *text_count = 0;
+    if (vec == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        *num_count += bitmap_test(vec->numeric, rows[i]);
+    }
+
+    SortKey* num  = keys;
+    SortKey* text = keys + *num_count;
+    for (size_t i = 0; i < count; i++) {
+        size_t r = rows[i];
+        if (bitmap_test(vec->numeric, r)) {
+            *num++ = (SortKey){.key = sort_key_number(vec->values[r]), .row = r};
+        } else if (!bitmap_test(vec->blank, r)) {
+            const char* cell = column_cache_text(cache, r, col);
+            *text++          = (SortKey){.key = sort_key_prefix(cell), .text = cell, .row = r};
+        }
+    }
+    *text_count = (size_t)(text - keys) - *num_count;
+}
+
+/** Where each kind of key lands in the sorted order: blanks, numbers, then text (reversed when descending). */
+typedef struct {
+    size_t blank_start;
+    size_t num_start;
+    size_t text_start;
+    size_t key_count;  // Rows that get a key (numbers and text)
+} SortLayout;
+
+/**
+ * Computes the output position of each kind of key for a list of rows.
  */
-static bool row_passes_filters(const Row* row, const char* filter_pattern, WhereFilter* where) {
-    if (!row_matches_filter(row, filter_pattern)) {
+static SortLayout sort_layout(const ColumnCache* cache, const ColumnVector* vec, const size_t* rows, size_t count,
+                              bool desc) {
+    size_t num_count   = vec != NULL ? vec->numeric_count : 0;
+    size_t blank_count = vec != NULL ? vec->blank_count : count;
+
+    // The column's totals only hold for the whole file
+    if (vec != NULL && count < cache->row_count) {
+        num_count   = 0;
+        blank_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            num_count += bitmap_test(vec->numeric, rows[i]);
+            blank_count += bitmap_test(vec->blank, rows[i]);
+        }
+    }
+    size_t text_count = count - num_count - blank_count;
+
+    SortLayout layout = {.blank_start = desc ? text_count + num_count : 0,
+                         .num_start   = desc ? text_count : blank_count,
+                         .text_start  = desc ? 0 : blank_count + num_count,
+                         .key_count   = num_count + text_count};
+    return layout;
+}
+
+/**
+ * Writes the blank rows, which are all equal and so stay in list order.
+ */
+static void emit_blank_rows(const ColumnVector* vec, const size_t* rows, size_t count, size_t* perm) {
+    for (size_t i = 0; i < count; i++) {
+        if (vec == NULL || bitmap_test(vec->blank, rows[i])) {
+            *perm++ = rows[i];
+        }
+    }
+}
+
+/**
+ * Radix sorts the rows on a single untyped field and writes the resulting row order to `perm`.
+ * @param keep Leading rows that must be in order (see sort_rows()).
+ */
+static bool sort_single_field(const ColumnCache* cache, const ColumnVector* vec, size_t col, bool desc,
+                           const size_t* rows, size_t count, size_t keep, size_t* perm) {
+    SortLayout layout = sort_layout(cache, vec, rows, count, desc);
+
+    SortKey* keys = malloc(sizeof(SortKey) * (layout.key_count > 0 ? layout.key_count : 1));
+    if (keys == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for sort\n");
         return false;
     }
 
-    if (where != NULL && !evaluate_where_filter(row, where)) {
+    size_t num_count, text_count;
+    decorate_rows(cache, vec, col, rows, count, keys, &num_count, &text_count);
+    SortKey* texts = keys + num_count;
+
+    // Keys past `keep` are never shown, so each kind only orders the part that lands before it
+    size_t num_keep  = keep > layout.num_start ? keep - layout.num_start : 0;
+    size_t text_keep = keep > layout.text_start ? keep - layout.text_start : 0;
+    if (!sort_keys_numbers(keys, num_count, num_keep, desc) || !sort_keys_text(texts, text_count, text_keep, desc)) {
+        fprintf(stderr, "Error: Memory allocation failed for sort\n");
+        free(keys);
         return false;
     }
 
+    emit_blank_rows(vec, rows, count, perm + layout.blank_start);
+    for (size_t i = 0; i < num_count; i++) {
+        perm[layout.num_start + i] = keys[i].row;
+    }
+    for (size_t i = 0; i < text_count; i++) {
+        perm[layout.text_start + i] = texts[i].row;
+    }
+
+    free(keys);
     return true;
 }
 
-// =============================================================================
-// SORTING
-// =============================================================================
+/**
+ * Bytes the composite key of row `r` takes (see encode_composite_key()).
+ */
+static size_t composite_key_size(const ColumnCache* cache, const ColumnVector* const* vecs, const SortField* fields,
+                                 size_t count, size_t r) {
+    size_t size = 0;
+    for (size_t k = 0; k < count; k++) {
+        const ColumnVector* vec = vecs[k];
+        bool blank              = vec == NULL || bitmap_test(vec->blank, r);
+        bool number             = !blank && bitmap_test(vec->numeric, r);
+
+        if (blank || (fields[k].type == SORT_NUMERIC && !number)) {
+            size += 1;
+        } else if (number && fields[k].type != SORT_TEXT) {
+            size += SORT_KEY_NUMBER_BYTES;
+        } else {
+            size += strlen(column_cache_text(cache, r, fields[k].col)) + 2;
+        }
+    }
+    return size;
+}
+
+/**
+ * Appends the keys of row `r` on every sort field into one memcmp-comparable string.
+ * @return Bytes written.
+ */
+static size_t encode_composite_key(const ColumnCache* cache, const ColumnVector* const* vecs, const SortField* fields,
+                                   size_t count, size_t r, unsigned char* out) {
+    unsigned char* start = out;
+    for (size_t k = 0; k < count; k++) {
+        const ColumnVector* vec = vecs[k];
+        bool blank              = vec == NULL || bitmap_test(vec->blank, r);
+        bool number             = !blank && bitmap_test(vec->numeric, r);
+
+        if (blank || (fields[k].type == SORT_NUMERIC && !number)) {
+            out += sort_key_encode_blank(out, fields[k].desc);
+        } else if (number && fields[k].type != SORT_TEXT) {
+            out += sort_key_encode_number(out, vec->values[r], fields[k].desc);
+        } else {
+            out += sort_key_encode_text(out, column_cache_text(cache, r, fields[k].col), fields[k].desc);
+        }
+    }
+    return (size_t)(out - start);
+}
 
 /**
- * Comparator function for qsort.
- * Tries to compare numerically first; falls back to string comparison.
+ * Sorts on several fields (or a typed one) through composite keys, each row's fields encoded
+ * once into a byte string so that every comparison is a single memcmp().
+ * @param keep Leading rows that must be in order (see sort_rows()).
  */
-static int compare_rows(const void* a, const void* b) {
-    const Row* r1 = *(const Row**)a;
-    const Row* r2 = *(const Row**)b;
+static bool sort_composite(ColumnCache* cache, const SortField* fields, size_t field_count, const size_t* rows,
+                           size_t n, size_t keep, size_t* perm) {
+    const ColumnVector* vecs[MAX_SORT_KEYS];
+    for (size_t k = 0; k < field_count; k++) {
+        vecs[k] = column_cache_get(cache, fields[k].col);
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += composite_key_size(cache, vecs, fields, field_count, rows[i]);
+    }
 
-    // Handle rows with missing columns safely
-    const char* val1 =
-        (sort_ctx.col_idx < r1->count && r1->fields[sort_ctx.col_idx]) ? r1->fields[sort_ctx.col_idx] : "";
-    const char* val2 =
-        (sort_ctx.col_idx < r2->count && r2->fields[sort_ctx.col_idx]) ? r2->fields[sort_ctx.col_idx] : "";
+    unsigned char* bytes = malloc(total > 0 ? total : 1);
+    SortKey* keys        = malloc(sizeof(SortKey) * n);
+    bool ok              = bytes != NULL && keys != NULL;
 
-    int result = 0;
+    unsigned char* out = bytes;
+    for (size_t i = 0; ok && i < n; i++) {
+        size_t len = encode_composite_key(cache, vecs, fields, field_count, rows[i], out);
+        keys[i]    = (SortKey){.key = len, .text = (const char*)out, .row = rows[i]};
+        out += len;
+    }
+
+    ok = ok && sort_keys_composite(keys, n, keep);
+    if (!ok) {
+        fprintf(stderr, "Error: Memory allocation failed for sort\n");
+    }
+    for (size_t i = 0; ok && i < n; i++) {
+        perm[i] = keys[i].row;
+    }
+
+    free(keys);
+    free(bytes);
+    return ok;
+}
+
+/**
+ * Parses a --sort list such as "region,-revenue,name".
+ * Each key is a column name or index, optionally prefixed with "-" (descending) or "+"
+ * (ascending) and suffixed with ":num" (numbers only) or ":text" (compare as text).
+ * @param desc_all --desc: reverses the direction of every key.
+ * @return Number of keys, or 0 if a key can't be resolved (reported on stderr).
+ */
+static size_t parse_sort_fields(const char* sort_str, const Row* header, bool desc_all, SortField* fields) {
+    char* str_copy = strdup(sort_str);
+    if (str_copy == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for sort\n");
+        return 0;
+    }
+
+    size_t count = 0;
+    bool ok      = true;
+    char* saveptr;
+    for (char* token = strtok_r(str_copy, ",", &saveptr); ok && token != NULL; token = strtok_r(NULL, ",", &saveptr)) {
+        // Trim whitespace
+        while (isspace((unsigned char)*token)) {
+            token++;
+        }
+        char* end = token + strlen(token);
+        while (end > token && isspace((unsigned char)end[-1])) {
+            *--end = '\0';
+        }
+
+        SortField field = {.desc = desc_all, .type = SORT_AUTO};
+        if (*token == '-' || *token == '+') {
+            field.desc = (*token == '-') != desc_all;
+            token++;
+        }
 
-    // Try numeric comparison first
-    char *end1, *end2;
-    double d1 = strtod(val1, &end1);
-    double d2 = strtod(val2, &end2);
-
-    // If both values parsed completely as numbers
-    if (*val1 != '\0' && *val2 != '\0' && *end1 == '\0' && *end2 == '\0') {
-        if (d1 < d2)
-            result = -1;
-        else if (d1 > d2)
-            result = 1;
-        else
-            result = 0;
+        size_t len = strlen(token);
+        if (len > 4 && strcasecmp(token + len - 4, ":num") == 0) {
+            field.type     = SORT_NUMERIC;
+            token[len - 4] = '\0';
+        } else if (len > 5 && strcasecmp(token + len - 5, ":text") == 0) {
+            field.type     = SORT_TEXT;
+            token[len - 5] = '\0';
+        }
+
+        char* endptr;
+        long parsed_idx = strtol(token, &endptr, 10);
+        ssize_t idx     = -1;
+        if (*token != '\0' && *endptr == '\0' && parsed_idx >= 0) {
+            idx = parsed_idx;
+        } else if (header != NULL) {
+            idx = find_column_by_name(header, token);
+        }
+
+        if (idx < 0) {
+            fprintf(stderr, "Warning: Could not resolve sort column '%s'. Sorting skipped.\n", token);
+            ok = false;
+        } else if (count == MAX_SORT_KEYS) {
+            fprintf(stderr, "Warning: More than %d sort keys. Sorting skipped.\n", MAX_SORT_KEYS);
+            ok = false;
+        } else {
+            field.col       = (size_t)idx;
+            fields[count++] = field;
+        }
+    }
+
+    free(str_copy);
+    return ok ? count : 0;
+}
+
+/**
+ * Orders two rows on one sort field, following the field's type and direction.
+ * @param vec The field's parsed column, or NULL if the rows have no such column.
+ */
+static int compare_sort_field(const ColumnCache* cache, const ColumnVector* vec, const SortField* field, size_t a,
+                              size_t b) {
+    if (vec == NULL) {
+        return 0;
+    }
+
+    int result;
+    if (field->type == SORT_AUTO) {
+        result = column_cache_compare(cache, field->col, a, b);
+    } else if (field->type == SORT_NUMERIC) {
+        bool num_a = bitmap_test(vec->numeric, a);
+        bool num_b = bitmap_test(vec->numeric, b);
+        uint64_t x = num_a ? sort_key_number(vec->values[a]) : 0;
+        uint64_t y = num_b ? sort_key_number(vec->values[b]) : 0;
+        result     = num_a != num_b ? num_a - num_b : (x > y) - (x < y);
     } else {
-        // Fallback to case-insensitive string comparison
-        result = strcasecmp(val1, val2);
+        bool blank_a = bitmap_test(vec->blank, a);
+        bool blank_b = bitmap_test(vec->blank, b);
+        result       = blank_a || blank_b ? blank_b - blank_a
+                                          : ascii_compare_nocase(column_cache_text(cache, a, field->col),
+                                                                 column_cache_text(cache, b, field->col));
     }
+    return field->desc ? -result : result;
+}
 
-    return sort_ctx.desc ? -result : result;
+/**
+ * Orders two rows on every sort field in turn.
+ */
+static int compare_sort_rows(const ColumnCache* cache, const ColumnVector* const* vecs, const SortField* fields,
+                             size_t field_count, size_t a, size_t b) {
+    int result = 0;
+    for (size_t k = 0; result == 0 && k < field_count; k++) {
+        result = compare_sort_field(cache, vecs[k], &fields[k], a, b);
+    }
+    return result;
 }
 
 /**
- * Sorts rows by a specified column.
- * @param rows Array of row pointers.
- * @param count Total number of rows.
- * @param has_header Whether the first row is a header.
- * @param sort_col Column name or index to sort by.
- * @param sort_desc Sort in descending order?
- * @return true on success, false if column not found.
+ * Reverses rows [lo, hi) of a list.
  */
-static bool sort_rows(Row** rows, size_t count, bool has_header, const char* sort_col, bool sort_desc) {
-    if (sort_col == NULL || count == 0) {
-        return false;
+static void reverse_rows(size_t* rows, size_t lo, size_t hi) {
+    for (; lo + 1 < hi; lo++, hi--) {
+        size_t swap  = rows[lo];
+        rows[lo]     = rows[hi - 1];
+        rows[hi - 1] = swap;
+    }
+}
+
+/**
+ * Checks whether a list of rows is already sorted, or sorted in reverse, in one pass, and
+ * leaves it in sorted order if so. Logs already in time order then skip the sort.
+ * @return true if `rows` is now sorted, false if it still needs a sort.
+ */
+static bool order_presorted_rows(ColumnCache* cache, const SortField* fields, size_t field_count, size_t* rows,
+                                 size_t count) {
+    const ColumnVector* vecs[MAX_SORT_KEYS];
+    for (size_t k = 0; k < field_count; k++) {
+        vecs[k] = column_cache_get(cache, fields[k].col);
+    }
+
+    // The order of a whole column may already be known from the sidecar index
+    if (field_count == 1 && fields[0].type == SORT_AUTO && vecs[0] != NULL &&
+        (column_cache_order(cache, fields[0].col) & (fields[0].desc ? COLUMN_ORDER_DESC : COLUMN_ORDER_ASC))) {
+        return true;
     }
 
-    long idx = -1;
-    char* endptr;
-    long parsed_idx = strtol(sort_col, &endptr, 10);
+    bool in_order = true;
+    bool reversed = true;
+    for (size_t i = 1; i < count && (in_order || reversed); i++) {
+        int cmp  = compare_sort_rows(cache, vecs, fields, field_count, rows[i - 1], rows[i]);
+        in_order = in_order && cmp <= 0;
+        reversed = reversed && cmp >= 0;
+    }
+    if (in_order || !reversed) {
+        return in_order;
+    }
 
-    // Determine Index
-    if (*endptr == '\0' && parsed_idx >= 0) {
-        idx = parsed_idx;
-    } else if (has_header) {
-        ssize_t found = find_column_by_name(rows[0], sort_col);
-        if (found >= 0) {
-            idx = found;
+    // Reversing the list also reverses runs of equal rows, which are then turned back
+    reverse_rows(rows, 0, count);
+    for (size_t start = 0; start < count;) {
+        size_t end = start + 1;
+        while (end < count && compare_sort_rows(cache, vecs, fields, field_count, rows[start], rows[end]) == 0) {
+            end++;
         }
+        reverse_rows(rows, start, end);
+        start = end;
     }
+    return true;
+}
 
-    if (idx < 0) {
-        fprintf(stderr, "Warning: Could not resolve sort column '%s'. Sorting skipped.\n", sort_col);
+/**
+ * Sorts a list of data rows by one or more columns.
+ * Each row's key is computed once (decorate), the keys are sorted, and the list is then
+ * rewritten in key order (undecorate). Only the listed rows are sorted, so filtering first
+ * leaves just the surviving rows to sort.
+ * A single untyped key is radix sorted on its number or text prefix; several keys are
+ * encoded into one composite key per row. Blank cells sort before numbers, and numbers
+ * before other text. Rows with equal keys keep their order in the list.
+ * @param cache Column cache over the data rows.
+ * @param header Header row used to resolve column names, or NULL.
+ * @param sort_str Sort keys (see parse_sort_fields()).
+ * @param sort_desc Reverse every key?
+ * @param rows Cache indices of the rows to sort, in increasing order; sorted in place.
+ * @param keep Leading rows that must be in order (offset + limit), SIZE_MAX for all.
+ *             The remaining rows are left in unspecified order.
+ * @return true on success, false if a column is not found.
+ */
+static bool sort_rows(ColumnCache* cache, const Row* header, const char* sort_str, bool sort_desc, size_t* rows,
+                      size_t count, size_t keep) {
+    if (sort_str == NULL || count == 0) {
         return false;
     }
 
-    sort_ctx.col_idx = (size_t)idx;
-    sort_ctx.desc    = sort_desc;
-    sort_ctx.active  = true;
+    SortField fields[MAX_SORT_KEYS];
+    size_t field_count = parse_sort_fields(sort_str, header, sort_desc, fields);
+    if (field_count == 0) {
+        return false;
+    }
 
-    // If we have a header, we must NOT sort row[0].
-    size_t sort_start_offset = has_header ? 1 : 0;
-    size_t sort_count        = (count > sort_start_offset) ? count - sort_start_offset : 0;
+    if (count < 2 || order_presorted_rows(cache, fields, field_count, rows, count)) {
+        return true;
+    }
 
-    if (sort_count > 1) {
-        qsort(rows + sort_start_offset, sort_count, sizeof(Row*), compare_rows);
+    size_t* perm = malloc(sizeof(size_t) * count);
+    if (perm == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for sort\n");
+        return false;
     }
 
-    return true;
+    bool ok;
+    if (field_count > 1 || fields[0].type != SORT_AUTO) {
+        ok = sort_composite(cache, fields, field_count, rows, count, keep, perm);
+    } else {
+        const SortField* f = &fields[0];
+        ok = sort_single_field(cache, column_cache_get(cache, f->col), f->col, f->desc, rows, count, keep, perm);
+    }
+
+    if (ok) {
+        memcpy(rows, perm, sizeof(size_t) * count);
+    }
+    free(perm);
+    return ok;
+}
+
+/**
+ * Sorts every data row and reorders the cache to match, for output paths that walk the
+ * cache in order (--queries).
+ * @return true on success, false if a column is not found.
+ */
+static bool sort_cache_rows(ColumnCache* cache, const Row* header, const char* sort_str, bool sort_desc) {
+    size_t* order = malloc(sizeof(size_t) * (cache->row_count > 0 ? cache->row_count : 1));
+    if (order == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for sort\n");
+        return false;
+    }
+
+    for (size_t r = 0; r < cache->row_count; r++) {
+        order[r] = r;
+    }
+
+    bool ok = sort_rows(cache, header, sort_str, sort_desc, order, cache->row_count, SIZE_MAX) &&
+              column_cache_permute(cache, order);
+    free(order);
+    return ok;
 }
 
 // =============================================================================
 // STRING ESCAPING AND SANITIZATION
 // =============================================================================
 
+/** Row index passed to get_field() for the header row, which is not part of the cache. */
+#define HEADER_ROW SIZE_MAX
+
 /**
- * Trims whitespace and escapes a string for JSON output.
- * @param arena Scratch arena for allocation.
- * @param str The string to process.
- * @return Allocated string with whitespace trimmed and special chars escaped.
+ * Looks up a cell together with its field info.
+ * Data cells reuse the info measured by the column cache; the header is measured on the spot.
+ * @param cache Column cache over the data rows.
+ * @param row The row holding the cell.
+ * @param row_idx Cache index of `row`, or HEADER_ROW.
+ * @param col Column index.
+ * @param info Output: the cell's field info.
+ * @return The cell text ("" if the row has no such field).
  */
-static char* trim_and_escape_json(Arena* arena, const char* s) {
-    if (s == NULL) {
-        return arena_strdup(arena, "");
+static const char* get_field(ColumnCache* cache, const Row* row, size_t row_idx, size_t col, FieldInfo* info) {
+    const FieldInfo* fields = row_idx != HEADER_ROW ? column_cache_fields_block(cache, col, row_idx) : NULL;
+    const char* text        = row_idx != HEADER_ROW ? column_cache_text(cache, row_idx, col)
+                              : (col < row->count && row->fields[col] != NULL) ? row->fields[col]
+                                                                                : "";
+
+    if (fields != NULL) {
+        *info = fields[row_idx];
+    } else {
+        field_info_compute(text, info);
     }
+    return text;
+}
 
-    char* str = (char*)s;
-    str       = trim_string(str);
-
-    size_t len    = strlen(str);
+/**
+ * Escapes a string for JSON output.
+ * @param arena Scratch arena for allocation.
+ * @param str The bytes to escape (usually an already trimmed field).
+ * @param len Number of bytes.
+ * @return Allocated string with special chars escaped.
+ */
+static char* escape_json(Arena* arena, const char* str, size_t len) {
     char* escaped = arena_alloc(arena, len * 2 + 1);
     if (escaped == NULL) {
         return NULL;
@@ -737,14 +1151,16 @@ static char* trim_and_escape_json(Arena* arena, const char* s) {
 /**
  * Escapes XML special characters for Excel/HTML output.
  * @param arena Scratch arena.
- * @param str Input string.
+ * @param str Input bytes.
+ * @param str_len Number of input bytes.
  * @return Escaped string.
  */
-static char* escape_xml(Arena* arena, const char* str) {
+static char* escape_xml(Arena* arena, const char* str, size_t str_len) {
     if (!str) return "";
 
-    size_t len = 0;
-    for (const char* p = str; *p; p++) {
+    const char* end = str + str_len;
+    size_t len      = 0;
+    for (const char* p = str; p < end; p++) {
         switch (*p) {
             case '<':
                 len += 4;
@@ -771,7 +1187,7 @@ static char* escape_xml(Arena* arena, const char* str) {
     if (!res) return "";
 
     char* dst = res;
-    for (const char* p = str; *p; p++) {
+    for (const char* p = str; p < end; p++) {
         switch (*p) {
             case '<':
                 strcpy(dst, "&lt;");
@@ -872,20 +1288,18 @@ static const char* get_header_cb(void* user_data, int col) {
  */
 static const char* get_cell_cb(void* user_data, int row, int col) {
     TableContext* ctx = (TableContext*)user_data;
-    Row* r            = ctx->rows[row];
+    size_t idx        = ctx->row_idx[row];
     size_t actual_col = ctx->col_mapping[col];
 
-    const char* val = "";
-    if (actual_col < r->count && r->fields[actual_col] != NULL) {
-        val = r->fields[actual_col];
-    }
+    FieldInfo info;
+    const char* val = get_field(ctx->cache, ctx->cache->rows[idx], idx, actual_col, &info);
 
     // Sanitize and color if needed
     if (ctx->use_colors) {
         const char* color = COLUMN_COLORS[(size_t)col % NUM_COLORS];
         const char* reset = COLOR_RESET;
 
-        size_t len       = strlen(val);
+        size_t len       = info.len;
         size_t color_len = strlen(color);
         size_t reset_len = strlen(reset);
 
@@ -904,12 +1318,13 @@ static const char* get_cell_cb(void* user_data, int row, int col) {
         p += color_len;
 
         // 2. Value (sanitized)
-        for (const char* v = val; *v; v++) {
-            if (*v == '\t' || *v == '\n' || *v == '\r') {
-                *p++ = ' ';
-            } else {
-                *p++ = *v;
+        if (info.flags & FIELD_HAS_CONTROL) {
+            for (size_t i = 0; i < len; i++) {
+                *p++ = (val[i] == '\t' || val[i] == '\n' || val[i] == '\r') ? ' ' : val[i];
             }
+        } else {
+            memcpy(p, val, len);
+            p += len;
         }
 
         // 3. Padding spaces
@@ -926,6 +1341,9 @@ static const char* get_cell_cb(void* user_data, int row, int col) {
     }
 
     // Non-colored path
+    if (!(info.flags & FIELD_HAS_CONTROL)) {
+        return val;
+    }
     return sanitize_for_display(ctx->arena, val);
 }
 
@@ -1146,45 +1564,164 @@ static int build_column_mapping(Arena* arena, size_t original_col_count, const C
 // =============================================================================
 
 /**
- * Filters rows based on pattern and WHERE clause.
+ * Filters data rows based on pattern and WHERE clause.
  * @param arena Arena for allocation.
- * @param rows All rows.
- * @param row_count Total number of rows.
- * @param has_header Whether first row is header.
+ * @param cache Column cache over the data rows.
  * @param filter_pattern Optional substring filter.
  * @param where Optional WHERE clause.
- * @param filtered_rows Output array of filtered row pointers.
+ * @param filtered_idx Output array of matching data row indices.
  * @return Number of filtered rows.
  */
-static size_t filter_rows(Arena* arena, Row** rows, size_t row_count, bool has_header, const char* filter_pattern,
-                          WhereFilter* where, Row*** filtered_rows) {
-    size_t start_row         = (has_header && row_count > 0) ? 1 : 0;
-    size_t data_row_capacity = row_count;
+static size_t filter_rows(Arena* arena, ColumnCache* cache, const char* filter_pattern, WhereFilter* where,
+                          size_t** filtered_idx) {
+    size_t data_row_capacity = cache->row_count > 0 ? cache->row_count : 1;
 
-    *filtered_rows = ARENA_ALLOC_ARRAY(arena, Row*, data_row_capacity);
-    if (*filtered_rows == NULL) {
+    *filtered_idx = ARENA_ALLOC_ARRAY(arena, size_t, data_row_capacity);
+    if (*filtered_idx == NULL) {
         return 0;
     }
 
     size_t filtered_count = 0;
-    for (size_t i = start_row; i < row_count; i++) {
-        if (row_passes_filters(rows[i], filter_pattern, where)) {
-            (*filtered_rows)[filtered_count++] = rows[i];
+    uint64_t selected[WHERE_BATCH_WORDS];
+
+    for (size_t start = 0; start < cache->row_count; start += WHERE_BATCH_ROWS) {
+        size_t n = cache->row_count - start < WHERE_BATCH_ROWS ? cache->row_count - start : WHERE_BATCH_ROWS;
+        select_rows_batch(cache, start, n, filter_pattern, where, selected);
+
+        for (size_t w = 0; w < BITMAP_WORDS(n); w++) {
+            uint64_t bits = selected[w];
+            while (bits != 0) {
+                (*filtered_idx)[filtered_count++] = start + w * 64 + bitmap_lowest(bits);
+                bits &= bits - 1;
+            }
         }
     }
 
     return filtered_count;
 }
 
+// =============================================================================
+// DUPLICATE ROWS
+// =============================================================================
+
+/**
+ * Hashes the key cells of a row, exactly as parsed (quotes removed, case and spaces kept).
+ */
+static uint64_t hash_row_key(const UniqueRows* unique, size_t row) {
+    uint64_t h = HASH_SEED;
+    for (size_t i = 0; i < unique->col_count; i++) {
+        FieldInfo info;
+        const char* text = get_field(unique->cache, unique->cache->rows[row], row, unique->cols[i], &info);
+
+        // The length separates the cells, so "ab","c" and "a","bc" differ
+        h = hash_bytes(h, &info.len, sizeof(info.len));
+        h = hash_bytes(h, text, info.len);
+    }
+    return h;
+}
+
+/**
+ * Compares the key cells of two rows (RowEqualFn of the seen-rows set).
+ */
+static bool row_keys_equal(const void* ctx, size_t a, size_t b) {
+    const UniqueRows* unique = ctx;
+    for (size_t i = 0; i < unique->col_count; i++) {
+        FieldInfo info_a, info_b;
+        const char* text_a = get_field(unique->cache, unique->cache->rows[a], a, unique->cols[i], &info_a);
+        const char* text_b = get_field(unique->cache, unique->cache->rows[b], b, unique->cols[i], &info_b);
+        if (info_a.len != info_b.len || memcmp(text_a, text_b, info_a.len) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Creates the set of keys seen so far.
+ */
+static RowSet* unique_set_create(Arena* arena, const UniqueRows* unique, size_t expected) {
+    return row_set_create(arena, expected, row_keys_equal, unique);
+}
+
+/**
+ * Drops rows whose key an earlier row of the list already has (a later one with keep_last),
+ * keeping the list order. One hash set lookup per row; no sorting.
+ * @param rows Data row indices, compacted in place.
+ * @param count In: rows in the list; out: rows kept.
+ * @return true on success, false on allocation failure (reported on stderr).
+ */
+static bool unique_rows(Arena* arena, const UniqueRows* unique, size_t* rows, size_t* count) {
+    size_t n     = *count;
+    RowSet* seen = unique_set_create(arena, unique, n);
+    if (seen == NULL) {
+        return false;
+    }
+
+    bool added;
+    if (!unique->keep_last) {
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (!row_set_add(seen, hash_row_key(unique, rows[i]), rows[i], &added)) {
+                return false;
+            }
+            if (added) {
+                rows[kept++] = rows[i];
+            }
+        }
+        *count = kept;
+        return true;
+    }
+
+    // Walking backwards, the last row of each key is seen first; kept rows fill the tail
+    size_t start = n;
+    for (size_t i = n; i-- > 0;) {
+        if (!row_set_add(seen, hash_row_key(unique, rows[i]), rows[i], &added)) {
+            return false;
+        }
+        if (added) {
+            rows[--start] = rows[i];
+        }
+    }
+    if (start > 0) {
+        memmove(rows, rows + start, sizeof(size_t) * (n - start));
+    }
+    *count = n - start;
+    return true;
+}
+
+/**
+ * Clears the bits of rows (row `first` + bit) whose key is in `seen`, adding the others,
+ * so duplicates are dropped while rows stream by in order.
+ * @param ok Set to false on allocation failure (reported on stderr).
+ */
+static uint64_t drop_seen_rows(RowSet* seen, const UniqueRows* unique, size_t first, uint64_t bits, bool* ok) {
+    uint64_t kept = 0;
+    for (; bits != 0; bits &= bits - 1) {
+        unsigned j = bitmap_lowest(bits);
+        bool added;
+        if (!row_set_add(seen, hash_row_key(unique, first + j), first + j, &added)) {
+            *ok = false;
+            return 0;
+        }
+        if (added) {
+            kept |= (uint64_t)1 << j;
+        }
+    }
+    return kept;
+}
+
 // =============================================================================
 // FORMAT-SPECIFIC OUTPUT
 // =============================================================================
 
 /**
  * Prints a single row in the specified format.
+ * Field lengths and quoting needs come from the cached field info, so no cell is rescanned.
+ * @param row_idx Cache index of `row`, or HEADER_ROW when printing the header line.
  */
-static void print_row_format(const Row* row, size_t col_count, OutputFormat format, const ColumnSelection* selection,
-                             const Row* header, bool is_last_row, Arena* scratch) {
+static void print_row_format(FILE* out, ColumnCache* cache, const Row* row, size_t row_idx, size_t col_count,
+                             OutputFormat format, const ColumnSelection* selection, const Row* header, bool is_last_row,
+                             Arena* scratch) {
     if (row == NULL) {
         return;
     }
@@ -1200,32 +1737,29 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
                 }
 
                 if (!first_field) {
-                    putchar(',');
+                    fputc(',', out);
                 }
 
-                const char* field = "";
-                if (col < row->count && row->fields[col] != NULL) {
-                    field = row->fields[col];
-                }
+                FieldInfo info;
+                const char* field = get_field(cache, row, row_idx, col, &info);
 
                 // Quote field if it contains comma, quote, or newline
-                bool needs_quotes = strchr(field, ',') || strchr(field, '"') || strchr(field, '\n');
-                if (needs_quotes) {
-                    putchar('"');
+                if (info.flags & FIELD_NEEDS_QUOTING) {
+                    fputc('"', out);
                     // Escape quotes by doubling them
                     for (const char* p = field; *p; p++) {
                         if (*p == '"') {
-                            putchar('"');
+                            fputc('"', out);
                         }
-                        putchar(*p);
+                        fputc(*p, out);
                     }
-                    putchar('"');
+                    fputc('"', out);
                 } else {
-                    fputs(field, stdout);
+                    fwrite(field, 1, info.len, out);
                 }
                 first_field = false;
             }
-            putchar('\n');
+            fputc('\n', out);
             break;
         }
 
@@ -1239,23 +1773,21 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
                 }
 
                 if (!first_field) {
-                    putchar('\t');
+                    fputc('\t', out);
                 }
 
-                const char* field = "";
-                if (col < row->count && row->fields[col] != NULL) {
-                    field = row->fields[col];
-                }
+                FieldInfo info;
+                const char* field = get_field(cache, row, row_idx, col, &info);
 
-                fputs(field, stdout);
+                fwrite(field, 1, info.len, out);
                 first_field = false;
             }
-            putchar('\n');
+            fputc('\n', out);
             break;
         }
 
         case OUTPUT_JSON: {
-            printf("  {");
+            fprintf(out, "  {");
             bool first_field = true;
             for (size_t i = 0; i < col_count; i++) {
                 size_t col = selection != NULL ? selection->indices[i] : i;
@@ -1265,33 +1797,34 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
                 }
 
                 if (!first_field) {
-                    printf(", ");
+                    fprintf(out, ", ");
                 }
 
-                const char* field_name = "field";
+                const char* key = "field";
+                size_t key_len  = 5;
                 if (header != NULL && col < header->count && header->fields[col] != NULL) {
-                    field_name = header->fields[col];
+                    FieldInfo key_info;
+                    key = field_trimmed(get_field(cache, header, HEADER_ROW, col, &key_info), &key_info, &key_len);
                 }
 
-                const char* field = "";
-                if (col < row->count && row->fields[col] != NULL) {
-                    field = row->fields[col];
-                }
+                FieldInfo info;
+                size_t len        = 0;
+                const char* value = field_trimmed(get_field(cache, row, row_idx, col, &info), &info, &len);
 
-                char* escaped_key = trim_and_escape_json(scratch, field_name);
-                char* escaped_val = trim_and_escape_json(scratch, field);
+                char* escaped_key = escape_json(scratch, key, key_len);
+                char* escaped_val = escape_json(scratch, value, len);
 
-                printf("\"%s\": \"%s\"", escaped_key != NULL ? escaped_key : "",
+                fprintf(out, "\"%s\": \"%s\"", escaped_key != NULL ? escaped_key : "",
                        escaped_val != NULL ? escaped_val : "");
 
                 first_field = false;
             }
-            printf("}%s\n", is_last_row ? "" : ",");
+            fprintf(out, "}%s\n", is_last_row ? "" : ",");
             break;
         }
 
         case OUTPUT_MARKDOWN: {
-            putchar('|');
+            fputc('|', out);
             for (size_t i = 0; i < col_count; i++) {
                 size_t col = selection != NULL ? selection->indices[i] : i;
 
@@ -1299,19 +1832,19 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
                     continue;
                 }
 
-                const char* field = "";
-                if (col < row->count && row->fields[col] != NULL) {
-                    field = row->fields[col];
-                }
+                FieldInfo info;
+                const char* field = get_field(cache, row, row_idx, col, &info);
 
-                printf(" %s |", field);
+                fputc(' ', out);
+                fwrite(field, 1, info.len, out);
+                fputs(" |", out);
             }
-            putchar('\n');
+            fputc('\n', out);
             break;
         }
 
         case OUTPUT_HTML: {
-            printf("<tr>");
+            fprintf(out, "<tr>");
             for (size_t i = 0; i < col_count; i++) {
                 size_t col = selection != NULL ? selection->indices[i] : i;
 
@@ -1319,20 +1852,18 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
                     continue;
                 }
 
-                const char* field = "";
-                if (col < row->count && row->fields[col] != NULL) {
-                    field = row->fields[col];
-                }
+                FieldInfo info;
+                const char* field = get_field(cache, row, row_idx, col, &info);
 
-                char* escaped = escape_xml(scratch, field);
-                printf("<td>%s</td>", escaped);
+                char* escaped = escape_xml(scratch, field, info.len);
+                fprintf(out, "<td>%s</td>", escaped);
             }
-            printf("</tr>\n");
+            fprintf(out, "</tr>\n");
             break;
         }
 
         case OUTPUT_EXCEL: {
-            printf("   <Row>\n");
+            fprintf(out, "   <Row>\n");
             for (size_t i = 0; i < col_count; i++) {
                 size_t col = selection != NULL ? selection->indices[i] : i;
 
@@ -1340,26 +1871,20 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
                     continue;
                 }
 
-                char* field = "";
-                if (col < row->count && row->fields[col] != NULL) {
-                    field = row->fields[col];
-                    field = trim_string(field);
-                }
-
-                // Check if number
-                char* endptr;
-                strtod(field, &endptr);
-                bool is_num = (*field != '\0' && *endptr == '\0');
+                FieldInfo info;
+                size_t len        = 0;
+                const char* field = field_trimmed(get_field(cache, row, row_idx, col, &info), &info, &len);
+                bool is_num       = (info.flags & FIELD_IS_NUMERIC) != 0;
 
-                char* escaped = escape_xml(scratch, field);
+                char* escaped = escape_xml(scratch, field, len);
 
                 if (is_num) {
-                    printf("    <Cell><Data ss:Type=\"Number\">%s</Data></Cell>\n", escaped);
+                    fprintf(out, "    <Cell><Data ss:Type=\"Number\">%s</Data></Cell>\n", escaped);
                 } else {
-                    printf("    <Cell><Data ss:Type=\"String\">%s</Data></Cell>\n", escaped);
+                    fprintf(out, "    <Cell><Data ss:Type=\"String\">%s</Data></Cell>\n", escaped);
                 }
             }
-            printf("   </Row>\n");
+            fprintf(out, "   </Row>\n");
             break;
         }
 
@@ -1371,17 +1896,17 @@ static void print_row_format(const Row* row, size_t col_count, OutputFormat form
 /**
  * Prints markdown table separator after header.
  */
-static void print_markdown_separator(size_t col_count, const ColumnSelection* selection) {
-    putchar('|');
+static void print_markdown_separator(FILE* out, size_t col_count, const ColumnSelection* selection) {
+    fputc('|', out);
     for (size_t i = 0; i < col_count; i++) {
         size_t col = selection != NULL ? selection->indices[i] : i;
 
         if (selection == NULL && is_column_hidden(col)) {
             continue;
         }
-        printf(" --- |");
+        fprintf(out, " --- |");
     }
-    putchar('\n');
+    fputc('\n', out);
 }
 
 // =============================================================================
@@ -1392,8 +1917,8 @@ static void print_markdown_separator(size_t col_count, const ColumnSelection* se
  * Computes column widths for colored output.
  * This is necessary because when using colors, we manually pad cells.
  */
-static size_t* compute_column_widths(Arena* arena, Row** rows, size_t row_count, const Row* header, size_t* col_mapping,
-                                     int visible_cols) {
+static size_t* compute_column_widths(Arena* arena, ColumnCache* cache, const size_t* row_idx, size_t row_count,
+                                     const Row* header, size_t* col_mapping, int visible_cols) {
     size_t* widths = ARENA_ALLOC_ARRAY(arena, size_t, visible_cols);
     if (!widths) return NULL;
 
@@ -1407,13 +1932,16 @@ static size_t* compute_column_widths(Arena* arena, Row** rows, size_t row_count,
             if (h_len > widths[j]) widths[j] = h_len;
         }
 
-        // Check data rows
+        // Check data rows (lengths were measured once by the column cache)
+        const FieldInfo* fields = column_cache_fields(cache, original_col);
         for (size_t i = 0; i < row_count; i++) {
-            Row* r = rows[i];
-            if (original_col < r->count && r->fields[original_col]) {
-                size_t len = strlen(r->fields[original_col]);
-                if (len > widths[j]) widths[j] = len;
+            size_t len = 0;
+            if (fields != NULL) {
+                len = fields[row_idx[i]].len;
+            } else {
+                len = strlen(column_cache_text(cache, row_idx[i], original_col));
             }
+            if (len > widths[j]) widths[j] = len;
         }
     }
 
@@ -1423,15 +1951,16 @@ static size_t* compute_column_widths(Arena* arena, Row** rows, size_t row_count,
 /**
  * Prints data as a pretty table using the prettytable library.
  */
-static void print_pretty_table(Row** filtered_rows, size_t filtered_count, const Row* header, size_t* col_mapping,
-                               int visible_cols, bool use_colors, Arena* arena) {
+static void print_pretty_table(ColumnCache* cache, const size_t* row_idx, size_t filtered_count, const Row* header,
+                               size_t* col_mapping, int visible_cols, bool use_colors, Arena* arena) {
     // Compute widths if using colors (needed for manual padding)
     size_t* widths = NULL;
     if (use_colors) {
-        widths = compute_column_widths(arena, filtered_rows, filtered_count, header, col_mapping, visible_cols);
+        widths = compute_column_widths(arena, cache, row_idx, filtered_count, header, col_mapping, visible_cols);
     }
 
-    TableContext ctx = {.rows        = filtered_rows,
+    TableContext ctx = {.cache       = cache,
+                        .row_idx     = row_idx,
                         .col_mapping = col_mapping,
                         .widths      = widths,
                         .use_colors  = use_colors,
@@ -1460,17 +1989,17 @@ static void print_pretty_table(Row** filtered_rows, size_t filtered_count, const
 /**
  * Prints format-specific headers.
  */
-static void print_format_header(OutputFormat format, bool has_header, Row** rows, size_t col_count,
+static void print_format_header(FILE* out, OutputFormat format, bool has_header, Row** rows, size_t col_count,
                                 const ColumnSelection* selection, Arena* scratch) {
     switch (format) {
         case OUTPUT_JSON:
-            printf("[\n");
+            fprintf(out, "[\n");
             break;
 
         case OUTPUT_HTML:
-            printf("<table>\n");
+            fprintf(out, "<table>\n");
             if (has_header) {
-                printf("  <thead>\n    <tr>");
+                fprintf(out, "  <thead>\n    <tr>");
                 for (size_t i = 0; i < col_count; i++) {
                     size_t col = selection != NULL ? selection->indices[i] : i;
                     if (selection == NULL && is_column_hidden(col)) continue;
@@ -1479,33 +2008,33 @@ static void print_format_header(OutputFormat format, bool has_header, Row** rows
                     if (col < rows[0]->count && rows[0]->fields[col] != NULL) {
                         field = rows[0]->fields[col];
                     }
-                    char* escaped = escape_xml(scratch, field);
-                    printf("<th>%s</th>", escaped);
+                    char* escaped = escape_xml(scratch, field, strlen(field));
+                    fprintf(out, "<th>%s</th>", escaped);
                 }
-                printf("</tr>\n  </thead>\n  <tbody>\n");
+                fprintf(out, "</tr>\n  </thead>\n  <tbody>\n");
             } else {
-                printf("  <tbody>\n");
+                fprintf(out, "  <tbody>\n");
             }
             break;
 
         case OUTPUT_EXCEL:
-            printf("<?xml version=\"1.0\"?>\n");
-            printf("<?mso-application progid=\"Excel.Sheet\"?>\n");
-            printf("<Workbook xmlns=\"urn:schemas-microsoft-com:office:spreadsheet\"\n");
-            printf(" xmlns:o=\"urn:schemas-microsoft-com:office:office\"\n");
-            printf(" xmlns:x=\"urn:schemas-microsoft-com:office:excel\"\n");
-            printf(" xmlns:ss=\"urn:schemas-microsoft-com:office:spreadsheet\"\n");
-            printf(" xmlns:html=\"http://www.w3.org/TR/REC-html40\">\n");
-            printf(" <Styles>\n");
-            printf("  <Style ss:ID=\"sHeader\">\n");
-            printf("   <Font ss:Bold=\"1\"/>\n");
-            printf("  </Style>\n");
-            printf(" </Styles>\n");
-            printf(" <Worksheet ss:Name=\"Sheet1\">\n");
-            printf("  <Table>\n");
+            fprintf(out, "<?xml version=\"1.0\"?>\n");
+            fprintf(out, "<?mso-application progid=\"Excel.Sheet\"?>\n");
+            fprintf(out, "<Workbook xmlns=\"urn:schemas-microsoft-com:office:spreadsheet\"\n");
+            fprintf(out, " xmlns:o=\"urn:schemas-microsoft-com:office:office\"\n");
+            fprintf(out, " xmlns:x=\"urn:schemas-microsoft-com:office:excel\"\n");
+            fprintf(out, " xmlns:ss=\"urn:schemas-microsoft-com:office:spreadsheet\"\n");
+            fprintf(out, " xmlns:html=\"http://www.w3.org/TR/REC-html40\">\n");
+            fprintf(out, " <Styles>\n");
+            fprintf(out, "  <Style ss:ID=\"sHeader\">\n");
+            fprintf(out, "   <Font ss:Bold=\"1\"/>\n");
+            fprintf(out, "  </Style>\n");
+            fprintf(out, " </Styles>\n");
+            fprintf(out, " <Worksheet ss:Name=\"Sheet1\">\n");
+            fprintf(out, "  <Table>\n");
 
             if (has_header) {
-                printf("   <Row>\n");
+                fprintf(out, "   <Row>\n");
                 for (size_t i = 0; i < col_count; i++) {
                     size_t col = selection != NULL ? selection->indices[i] : i;
                     if (selection == NULL && is_column_hidden(col)) continue;
@@ -1514,10 +2043,11 @@ static void print_format_header(OutputFormat format, bool has_header, Row** rows
                     if (col < rows[0]->count && rows[0]->fields[col] != NULL) {
                         field = rows[0]->fields[col];
                     }
-                    char* escaped = escape_xml(scratch, field);
-                    printf("    <Cell ss:StyleID=\"sHeader\"><Data ss:Type=\"String\">%s</Data></Cell>\n", escaped);
+                    char* escaped = escape_xml(scratch, field, strlen(field));
+                    fprintf(out, "    <Cell ss:StyleID=\"sHeader\"><Data ss:Type=\"String\">%s</Data></Cell>\n",
+                            escaped);
                 }
-                printf("   </Row>\n");
+                fprintf(out, "   </Row>\n");
             }
             break;
 
@@ -1530,25 +2060,26 @@ static void print_format_header(OutputFormat format, bool has_header, Row** rows
 /**
  * Prints format-specific footers.
  */
-static void print_format_footer(OutputFormat format, size_t filtered_count, size_t total_data_rows, bool has_filter) {
+static void print_format_footer(FILE* out, OutputFormat format, size_t filtered_count, size_t total_data_rows,
+                                bool has_filter) {
     switch (format) {
         case OUTPUT_JSON:
-            printf("]\n");
+            fprintf(out, "]\n");
             break;
 
         case OUTPUT_HTML:
-            printf("  </tbody>\n</table>\n");
+            fprintf(out, "  </tbody>\n</table>\n");
             break;
 
         case OUTPUT_EXCEL:
-            printf("  </Table>\n");
-            printf(" </Worksheet>\n");
-            printf("</Workbook>\n");
+            fprintf(out, "  </Table>\n");
+            fprintf(out, " </Worksheet>\n");
+            fprintf(out, "</Workbook>\n");
             break;
 
         case OUTPUT_MARKDOWN:
             if (has_filter) {
-                printf("\nFiltered: %zu/%zu rows matched\n", filtered_count, total_data_rows);
+                fprintf(out, "\nFiltered: %zu/%zu rows matched\n", filtered_count, total_data_rows);
             }
             break;
 
@@ -1557,6 +2088,22 @@ static void print_format_footer(OutputFormat format, size_t filtered_count, size
     }
 }
 
+/**
+ * Prints everything that precedes the data rows: the format header and, for CSV, TSV and
+ * Markdown, the header row.
+ */
+static void print_output_start(FILE* out, OutputFormat format, bool has_header, Row** rows, ColumnCache* cache,
+                               size_t col_count, const ColumnSelection* selection, Arena* scratch) {
+    print_format_header(out, format, has_header, rows, col_count, selection, scratch);
+
+    if (has_header && format != OUTPUT_JSON && format != OUTPUT_HTML && format != OUTPUT_EXCEL) {
+        print_row_format(out, cache, rows[0], HEADER_ROW, col_count, format, selection, NULL, false, scratch);
+        if (format == OUTPUT_MARKDOWN) {
+            print_markdown_separator(out, col_count, selection);
+        }
+    }
+}
+
 // =============================================================================
 // MAIN PRINT FUNCTION
 // =============================================================================
@@ -1564,7 +2111,7 @@ static void print_format_footer(OutputFormat format, size_t filtered_count, size
 /**
  * Pretty-prints the CSV data in the specified format.
  */
-static void print_table(Row** rows, size_t row_count, const PrintConfig* config) {
+static void print_table(Row** rows, size_t row_count, ColumnCache* cache, const PrintConfig* config) {
     if (row_count == 0 || rows[0]->count == 0) {
         fprintf(stderr, "Error: No data to print\n");
         return;
@@ -1594,20 +2141,30 @@ static void print_table(Row** rows, size_t row_count, const PrintConfig* config)
         return;
     }
 
-    // Filter rows
-    Row** filtered_rows   = NULL;
-    size_t filtered_count = filter_rows(print_arena, rows, row_count, config->has_header, config->filter_pattern,
-                                        config->where, &filtered_rows);
+    // Filter rows, then sort only the survivors; just the rows up to offset + limit need ordering
+    size_t* filtered_idx  = NULL;
+    size_t filtered_count = filter_rows(print_arena, cache, config->filter_pattern, config->where, &filtered_idx);
+    if (config->unique != NULL && !unique_rows(print_arena, config->unique, filtered_idx, &filtered_count)) {
+        arena_destroy(print_arena);
+        return;
+    }
+    if (config->sort != NULL) {
+        size_t keep = config->limit > SIZE_MAX - config->offset ? SIZE_MAX : config->offset + config->limit;
+        sort_rows(cache, config->has_header ? rows[0] : NULL, config->sort, config->sort_desc, filtered_idx,
+                  filtered_count, keep);
+    }
 
     size_t window_start = 0;
     size_t window_count = 0;
     compute_row_window(filtered_count, config->offset, config->limit, &window_start, &window_count);
-    Row** window_rows = filtered_rows + window_start;
+
+    // Rows are printed straight from their cache indices
+    const size_t* window_idx = filtered_idx + window_start;
 
     // Print based on format
     if (config->format == OUTPUT_TABLE) {
         const Row* header = config->has_header ? rows[0] : NULL;
-        print_pretty_table(window_rows, window_count, header, col_mapping, visible_cols, config->use_colors,
+        print_pretty_table(cache, window_idx, window_count, header, col_mapping, visible_cols, config->use_colors,
                            print_arena);
     } else {
         // Other formats
@@ -1619,22 +2176,16 @@ static void print_table(Row** rows, size_t row_count, const PrintConfig* config)
         }
 
         // Print header
-        print_format_header(config->format, config->has_header, rows, col_count, config->selection, scratch);
-
-        // Print data header for CSV/TSV/Markdown
-        if (config->has_header && config->format != OUTPUT_JSON && config->format != OUTPUT_HTML &&
-            config->format != OUTPUT_EXCEL) {
-            print_row_format(rows[0], col_count, config->format, config->selection, NULL, false, scratch);
-            if (config->format == OUTPUT_MARKDOWN) {
-                print_markdown_separator(col_count, config->selection);
-            }
-        }
+        print_output_start(stdout, config->format, config->has_header, rows, cache, col_count, config->selection,
+                           scratch);
 
         // Print data rows
         for (size_t i = 0; i < window_count; i++) {
             bool is_last      = (i == window_count - 1);
             const Row* header = config->has_header ? rows[0] : NULL;
-            print_row_format(window_rows[i], col_count, config->format, config->selection, header, is_last, scratch);
+            size_t idx        = window_idx[i];
+            print_row_format(stdout, cache, cache->rows[idx], idx, col_count, config->format, config->selection, header,
+                             is_last, scratch);
             arena_reset(scratch);
         }
 
@@ -1642,7 +2193,7 @@ static void print_table(Row** rows, size_t row_count, const PrintConfig* config)
         size_t total_data_rows = row_count - (config->has_header ? 1 : 0);
         bool has_filter =
             (config->filter_pattern != NULL && config->filter_pattern[0] != '\0') || (config->where != NULL);
-        print_format_footer(config->format, filtered_count, total_data_rows, has_filter);
+        print_format_footer(stdout, config->format, filtered_count, total_data_rows, has_filter);
 
         arena_destroy(scratch);
     }
@@ -1650,6 +2201,459 @@ static void print_table(Row** rows, size_t row_count, const PrintConfig* config)
     arena_destroy(print_arena);
 }
 
+// =============================================================================
+// MULTI-QUERY MODE
+// =============================================================================
+
+/** Maximum number of queries in a --queries file. */
+#define MAX_QUERIES 256
+
+/** Longest line accepted in a --queries file. */
+#define MAX_QUERY_LINE 8192
+
+/** One named query of a --queries file. */
+typedef struct {
+    char* name;         // Label printed with the count
+    WhereFilter where;  // Parsed condition (NULL root matches every row)
+    char* target;       // Output file, or NULL to only count
+    FILE* out;          // Open stream for `target`
+    size_t matched;     // Rows that passed the filters
+    size_t pending;     // Matched row not yet printed (SIZE_MAX if none), so the last row is known for JSON
+    RowSet* seen;       // Keys of the rows matched so far with --distinct/--unique-by, else NULL
+} NamedQuery;
+
+/**
+ * Trims whitespace at both ends of a string in place.
+ */
+static char* trim_in_place(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    size_t len = strlen(s);
+    while (len > 0 && isspace((unsigned char)s[len - 1])) s[--len] = '\0';
+    return s;
+}
+
+/**
+ * Loads a --queries file. Each non-blank line that doesn't start with '#' reads
+ * "name: condition" or "name: condition -> output-file".
+ * @return Number of queries, or (size_t)-1 on error (reported on stderr).
+ */
+static size_t load_queries(Arena* arena, const char* path, NamedQuery* queries) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "Error: Cannot open queries file '%s'\n", path);
+        return (size_t)-1;
+    }
+
+    char line[MAX_QUERY_LINE];
+    size_t count   = 0;
+    size_t line_no = 0;
+    bool ok        = true;
+
+    while (ok && fgets(line, sizeof(line), f) != NULL) {
+        line_no++;
+        char* text = trim_in_place(line);
+        if (*text == '\0' || *text == '#') continue;
+
+        char* colon = strchr(text, ':');
+        if (colon == NULL || count == MAX_QUERIES) {
+            fprintf(stderr, "Error: %s:%zu: %s\n", path, line_no,
+                    colon == NULL ? "expected 'name: condition [-> file]'" : "too many queries");
+            ok = false;
+            break;
+        }
+        *colon = '\0';
+
+        // The output file follows the last "->"
+        char* target = NULL;
+        for (char* p = strstr(colon + 1, "->"); p != NULL; p = strstr(p + 2, "->")) {
+            target = p;
+        }
+        if (target != NULL) {
+            *target = '\0';
+            target  = trim_in_place(target + 2);
+        }
+
+        NamedQuery* q = &queries[count];
+        memset(q, 0, sizeof(*q));
+        q->name      = arena_strdup(arena, trim_in_place(text));
+        q->target    = (target != NULL && *target != '\0') ? arena_strdup(arena, target) : NULL;
+        q->pending   = SIZE_MAX;
+        char* clause = trim_in_place(colon + 1);
+
+        if (q->name == NULL || (target != NULL && *target != '\0' && q->target == NULL)) {
+            fprintf(stderr, "Error: Memory allocation failed for queries\n");
+            ok = false;
+        } else if (*clause != '\0' && !parse_where_clause(arena, clause, &q->where)) {
+            fprintf(stderr, "Error: %s:%zu: invalid condition '%s'\n", path, line_no, clause);
+            ok = false;
+        } else {
+            count++;
+        }
+    }
+    fclose(f);
+
+    if (!ok) {
+        for (size_t i = 0; i < count; i++) free_where_filter(&queries[i].where);
+        return (size_t)-1;
+    }
+    return count;
+}
+
+/**
+ * Evaluates every query in one pass over the rows. Each batch of rows is tested against
+ * all queries while it is hot in cache; matches are streamed to each query's output file
+ * (within --offset/--limit) and counted. Counts are printed as "name<TAB>count" lines.
+ * Files use the configured format, except that the table format falls back to CSV.
+ * The queries' where trees must already be resolved.
+ * @return true on success, false if an output file can't be opened.
+ */
+static bool run_queries(Row** rows, ColumnCache* cache, const PrintConfig* config, NamedQuery* queries, size_t count) {
+    size_t col_count    = config->selection != NULL ? config->selection->count : rows[0]->count;
+    OutputFormat format = config->format == OUTPUT_TABLE ? OUTPUT_CSV : config->format;
+    const Row* header   = config->has_header ? rows[0] : NULL;
+    size_t end          = config->limit > SIZE_MAX - config->offset ? SIZE_MAX : config->offset + config->limit;
+    bool ok             = true;
+
+    Arena* scratch = arena_create(0);
+    if (!scratch) {
+        fprintf(stderr, "Error: Failed to create scratch arena\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (queries[i].target == NULL) continue;
+
+        queries[i].out = fopen(queries[i].target, "w");
+        if (queries[i].out == NULL) {
+            fprintf(stderr, "Error: Cannot write query output '%s'\n", queries[i].target);
+            ok = false;
+            continue;
+        }
+        print_output_start(queries[i].out, format, config->has_header, rows, cache, col_count, config->selection,
+                           scratch);
+        arena_reset(scratch);
+    }
+
+    // Rows stream in order, so each query drops a duplicate as soon as its key was seen
+    Arena* seen_arena = NULL;
+    if (config->unique != NULL) {
+        seen_arena = arena_create(0);
+        if (seen_arena == NULL) {
+            fprintf(stderr, "Error: Failed to create arena for duplicate rows\n");
+            ok = false;
+        }
+        for (size_t i = 0; ok && i < count; i++) {
+            queries[i].seen = unique_set_create(seen_arena, config->unique, 0);
+            ok              = queries[i].seen != NULL;
+        }
+    }
+
+    uint64_t selected[WHERE_BATCH_WORDS];
+    for (size_t start = 0; ok && start < cache->row_count; start += WHERE_BATCH_ROWS) {
+        size_t n = cache->row_count - start < WHERE_BATCH_ROWS ? cache->row_count - start : WHERE_BATCH_ROWS;
+
+        for (size_t i = 0; i < count; i++) {
+            NamedQuery* q = &queries[i];
+            select_rows_batch(cache, start, n, config->filter_pattern, q->where.root != NULL ? &q->where : NULL,
+                              selected);
+
+            for (size_t w = 0; w < BITMAP_WORDS(n); w++) {
+                uint64_t bits = selected[w];
+                if (q->seen != NULL) {
+                    bits = drop_seen_rows(q->seen, config->unique, start + w * 64, bits, &ok);
+                }
+                if (q->out == NULL) {
+                    q->matched += bitmap_popcount(bits);
+                    continue;
+                }
+
+                while (bits != 0) {
+                    unsigned j = bitmap_lowest(bits);
+                    bits &= bits - 1;
+
+                    if (q->matched >= config->offset && q->matched < end) {
+                        if (q->pending != SIZE_MAX) {
+                            print_row_format(q->out, cache, cache->rows[q->pending], q->pending, col_count, format,
+                                             config->selection, header, false, scratch);
+                            arena_reset(scratch);
+                        }
+                        q->pending = start + w * 64 + j;
+                    }
+                    q->matched++;
+                }
+            }
+        }
+    }
+
+    size_t total_rows = cache->row_count;
+    bool has_filter   = config->filter_pattern != NULL && config->filter_pattern[0] != '\0';
+    for (size_t i = 0; i < count; i++) {
+        NamedQuery* q = &queries[i];
+        if (q->out != NULL) {
+            if (q->pending != SIZE_MAX) {
+                print_row_format(q->out, cache, cache->rows[q->pending], q->pending, col_count, format,
+                                 config->selection, header, true, scratch);
+                arena_reset(scratch);
+            }
+            print_format_footer(q->out, format, q->matched, total_rows, has_filter || q->where.root != NULL);
+            if (fclose(q->out) != 0) {
+                fprintf(stderr, "Error: Failed to write query output '%s'\n", q->target);
+                ok = false;
+            }
+            q->out = NULL;
+        }
+        if (ok) {
+            printf("%s\t%zu\n", q->name, q->matched);
+        }
+    }
+
+    if (seen_arena != NULL) {
+        arena_destroy(seen_arena);
+    }
+    arena_destroy(scratch);
+    return ok;
+}
+
+// =============================================================================
+// SIDECAR INDEX
+// =============================================================================
+
+/**
+ * Installs the sidecar index of a file into the cache, building and saving it when it is
+ * missing, stale or lacks Bloom filters for a requested column. A missing index is never
+ * fatal: queries just scan every block.
+ * @param bloom_sel Columns that must have Bloom filters, or NULL.
+ */
+static void apply_sidecar_index(const char* filename, const CsvReaderConfig* config, ColumnCache* cache,
+                                const ColumnSelection* bloom_sel) {
+    SidecarKey key;
+    if (!sidecar_key_init(&key, filename, cache, config->delim, config->comment, config->has_header)) {
+        fprintf(stderr, "Warning: Cannot fingerprint '%s'; index not used\n", filename);
+        return;
+    }
+
+    bool loaded = sidecar_load(filename, &key, cache);
+
+    // Keep the Bloom filters already in the index and add the requested ones
+    bool* bloom_columns = calloc(cache->col_count > 0 ? cache->col_count : 1, sizeof(bool));
+    if (bloom_columns == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for index columns\n");
+        return;
+    }
+
+    bool missing = false;
+    for (size_t c = 0; c < cache->col_count; c++) {
+        bloom_columns[c] = cache->columns[c].blooms != NULL;
+    }
+    for (size_t i = 0; bloom_sel != NULL && i < bloom_sel->count; i++) {
+        size_t col = bloom_sel->indices[i];
+        if (col >= cache->col_count) {
+            fprintf(stderr, "Warning: Bloom column %zu out of range, skipping\n", col);
+        } else if (!bloom_columns[col]) {
+            bloom_columns[col] = true;
+            missing            = true;
+        }
+    }
+
+    if (!loaded || missing) {
+        sidecar_build(filename, &key, cache, bloom_columns);
+    }
+    free(bloom_columns);
+}
+
+// =============================================================================
+// COMPUTED COLUMNS
+// =============================================================================
+
+/**
+ * Computes one "name = expression" definition and appends it to the header and the cache.
+ * The expression is evaluated in batches over the cached numeric vectors, once per row; the
+ * cells' text is only formatted when it is needed (see column_cache_text()).
+ */
+static bool add_eval_column(Arena* arena, ColumnCache* cache, Row* header, const char* def) {
+    const char* eq = strchr(def, '=');
+    if (eq == NULL) {
+        fprintf(stderr, "Error: --eval needs 'name = expression', got '%s'\n", def);
+        return false;
+    }
+
+    const char* name = def;
+    const char* end  = eq;
+    while (name < end && isspace((unsigned char)*name)) name++;
+    while (end > name && isspace((unsigned char)end[-1])) end--;
+
+    Expr* expr = expr_compile(arena, eq + 1);
+    if (name == end || expr == NULL) {
+        fprintf(stderr, "Error: Invalid --eval definition '%s'\n", def);
+        return false;
+    }
+
+    char* header_txt = ARENA_ALLOC_ARRAY(arena, char, (size_t)(end - name) + 1);
+    char** fields    = ARENA_ALLOC_ARRAY(arena, char*, cache->col_count + 1);
+    if (header_txt == NULL || fields == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for computed column\n");
+        return false;
+    }
+    memcpy(header_txt, name, (size_t)(end - name));
+    header_txt[end - name] = '\0';
+
+    if (find_column_by_name(header, header_txt) >= 0) {
+        fprintf(stderr, "Error: --eval column '%s' already exists\n", header_txt);
+        return false;
+    }
+    if (!expr_resolve(expr, header)) {
+        return false;
+    }
+
+    size_t n        = cache->row_count;
+    double* values  = ARENA_ALLOC_ARRAY(arena, double, n > 0 ? n : 1);
+    uint64_t* valid = ARENA_ALLOC_ARRAY(arena, uint64_t, BITMAP_WORDS(n) + 1);
+    if (values == NULL || valid == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for computed column\n");
+        return false;
+    }
+
+    for (size_t start = 0; start < n; start += EXPR_BATCH_ROWS) {
+        size_t batch = (n - start) < EXPR_BATCH_ROWS ? (n - start) : EXPR_BATCH_ROWS;
+        if (!expr_eval_batch(cache, expr, start, batch, values + start, valid + start / 64)) {
+            return false;
+        }
+    }
+
+    // Only the header is widened; data rows get the column's text from the cache
+    size_t col  = cache->col_count;
+    size_t keep = header->count < col ? header->count : col;
+    memcpy(fields, header->fields, sizeof(char*) * keep);
+    for (size_t i = keep; i < col; i++) {
+        fields[i] = NULL;
+    }
+    fields[col]    = header_txt;
+    header->fields = fields;
+    header->count  = col + 1;
+
+    return column_cache_add_numeric(cache, values, valid) != (size_t)-1;
+}
+
+/**
+ * Adds the computed columns of a ';'-separated --eval list, left to right,
+ * so later definitions can use earlier ones.
+ * The parser's rows are left untouched: the header is replaced by an arena copy that can grow.
+ * @param rows All parsed rows, header first.
+ * @return The rows with the widened header first, or NULL on error (reported on stderr).
+ */
+static Row** add_eval_columns(Arena* arena, ColumnCache* cache, Row** rows, size_t count, bool has_header,
+                              const char* eval_str) {
+    if (!has_header) {
+        fprintf(stderr, "Error: --eval needs a header row to name columns\n");
+        return NULL;
+    }
+
+    Row** view  = ARENA_ALLOC_ARRAY(arena, Row*, count);
+    Row* header = ARENA_ALLOC_ZERO(arena, Row);
+    char* defs  = arena_strdup(arena, eval_str);
+    if (view == NULL || header == NULL || defs == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for --eval\n");
+        return NULL;
+    }
+
+    memcpy(view, rows, sizeof(Row*) * count);
+    *header     = *rows[0];
+    view[0]     = header;
+    cache->rows = view + 1;
+
+    char* saveptr;
+    for (char* def = strtok_r(defs, ";", &saveptr); def != NULL; def = strtok_r(NULL, ";", &saveptr)) {
+        if (!add_eval_column(arena, cache, view[0], def)) {
+            return NULL;
+        }
+    }
+    return view;
+}
+
+// =============================================================================
+// RESULT CACHE
+// =============================================================================
+
+/**
+ * Appends "name=<length>:value\n" to a key. Only whitespace at the ends of the value is dropped:
+ * spaces inside a value are significant ("a b" and "a  b" select different rows).
+ */
+static char* append_key_part(char* out, const char* name, const char* value) {
+    const char* start = value != NULL ? value : "";
+    while (isspace((unsigned char)*start)) {
+        start++;
+    }
+    size_t len = strlen(start);
+    while (len > 0 && isspace((unsigned char)start[len - 1])) {
+        len--;
+    }
+
+    out += sprintf(out, "%s=%zu:", name, len);
+    memcpy(out, start, len);
+    out += len;
+    *out++ = '\n';
+    *out   = '\0';
+    return out;
+}
+
+/**
+ * Builds the result-cache key: every option that changes the output, one per line.
+ * @param flags Boolean options packed into bits.
+ * @return The key in the arena, or NULL on allocation failure.
+ */
+static char* build_cache_key(Arena* arena, const char* where_str, const char* filter_pattern, const char* select_str,
+                             const char* sort_col, const char* unique_str, const char* eval_str, const char* hide_cols,
+                             OutputFormat format, size_t limit, size_t offset, char delimiter, char comment,
+                             unsigned flags) {
+    const char* names[]  = {"where", "filter", "select", "sort", "unique", "eval", "hide"};
+    const char* values[] = {where_str, filter_pattern, select_str, sort_col, unique_str, eval_str, hide_cols};
+    size_t parts         = sizeof(names) / sizeof(names[0]);
+
+    size_t cap = 128;
+    for (size_t i = 0; i < parts; i++) {
+        cap += strlen(names[i]) + 24 + (values[i] != NULL ? strlen(values[i]) : 0);
+    }
+
+    char* key = arena_alloc(arena, cap);
+    if (key == NULL) {
+        return NULL;
+    }
+
+    char* out = key;
+    for (size_t i = 0; i < parts; i++) {
+        out = append_key_part(out, names[i], values[i]);
+    }
+    sprintf(out, "format=%d\nlimit=%zu\noffset=%zu\ndelimiter=%d\ncomment=%d\nflags=%u\n", (int)format, limit, offset,
+            delimiter, comment, flags);
+    return key;
+}
+
+/**
+ * Reports whether a where tree reads an IN list from a file, which may change while the CSV
+ * stays the same.
+ */
+static bool uses_list_file(const ASTNode* node) {
+    if (node == NULL) {
+        return false;
+    }
+    if (node->type == NODE_LOGIC) {
+        return uses_list_file(node->left) || uses_list_file(node->right);
+    }
+    const WhereClause* wc = node->clause;
+    return wc->op == OP_IN && wc->value != NULL && wc->value[0] == '@';
+}
+
+/**
+ * Ends result capturing, if active, and passes the exit status through.
+ * Only successful runs that wrote nothing to stderr are kept in the cache.
+ */
+static int finish_capture(ResultCapture* capture, int status) {
+    if (capture->file != NULL) {
+        result_cache_end(capture, status == EXIT_SUCCESS);
+    }
+    return status;
+}
+
 // =============================================================================
 // COMMAND-LINE PARSING
 // =============================================================================
@@ -1730,6 +2734,14 @@ int main(int argc, char* argv[]) {
     char* sort_col       = NULL;
     bool count_only      = false;
     bool describe_only   = false;
+    bool distinct        = false;
+    char* unique_str     = NULL;
+    bool keep_last       = false;
+    bool use_index       = false;
+    char* bloom_str      = NULL;
+    char* eval_str       = NULL;
+    char* queries_str    = NULL;
+    char* cache_dir      = NULL;
     char* limit_str      = NULL;
     char* offset_str     = NULL;
     size_t limit         = SIZE_MAX;
@@ -1743,6 +2755,9 @@ int main(int argc, char* argv[]) {
     flag_bool(parser, "desc", 'D', "Sort in descending order", &sort_desc);
     flag_bool(parser, "count", 'n', "Print number of rows after filtering", &count_only);
     flag_bool(parser, "describe", 'a', "Print numeric stats (count/min/max/mean) for visible columns", &describe_only);
+    flag_bool(parser, "index", 'I', "Use a sidecar index (<file>.csvqi, built on first use) to skip blocks",
+              &use_index);
+    flag_string(parser, "bloom", 'b', "Columns to keep Bloom filters for in the index (implies --index)", &bloom_str);
     flag_char(parser, "comment", 'c', "Comment Character", &comment);
     flag_string(parser, "delimiter", 'd', "The CSV delimiter (use '\\t' for tab)", &delim_arg);
     flag_string(parser, "hide", 'H', "Comma-separated column indices to hide (e.g., 0,2,5)", &hide_cols);
@@ -1750,11 +2765,22 @@ int main(int argc, char* argv[]) {
     flag_string(parser, "where", 'w',
                 "Filter rows with condition (e.g., 'age > 25', 'name contains John' or 'age > 25 OR status = active')",
                 &where_str);
+    flag_string(parser, "eval", 'e', "Add computed columns (e.g., 'total = price * qty; tax = total * 0.2')",
+                &eval_str);
+    flag_string(parser, "queries", 'q', "Run every 'name: condition [-> file]' line of a file in one pass",
+                &queries_str);
+    flag_string(parser, "cache", 'K', "Reuse results of identical queries on an unchanged file from this directory",
+                &cache_dir);
     flag_string(parser, "select", 'S', "Select and order columns (e.g., 'name,age' or '0,2,1')", &select_str);
     flag_string(parser, "output", 'o', "Output format: table (default), csv, tsv, json, markdown", &format_str);
-    flag_string(parser, "sort", 'B', "Sort by column name or index", &sort_col);
+    flag_string(parser, "sort", 'B', "Sort by columns (e.g., 'region,-revenue')", &sort_col);
     flag_string(parser, "limit", 'l', "Limit output rows after filtering/sorting", &limit_str);
     flag_string(parser, "offset", 'O', "Skip N rows after filtering/sorting", &offset_str);
+    flag_bool(parser, "distinct", 'u', "Drop rows identical to an earlier row", &distinct);
+    flag_string(parser, "unique-by", 'U', "Keep one row per value of these columns (e.g., 'email' or 'region,day')",
+                &unique_str);
+    flag_bool(parser, "keep-last", 'L', "With --distinct/--unique-by, keep the last duplicate instead of the first",
+              &keep_last);
 
     // Parse flags
     if (flag_parse(parser, argc, argv) != FLAG_OK) {
@@ -1801,12 +2827,36 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    // Repeated queries against an unchanged file are answered from the result cache
+    ResultCapture capture = {.saved_fd = -1, .saved_err = -1};
+    if (cache_dir != NULL && queries_str == NULL) {
+        unsigned flags = (unsigned)has_header | (unsigned)use_colors << 1 | (unsigned)use_bgcolor << 2 |
+                         (unsigned)sort_desc << 3 | (unsigned)count_only << 4 | (unsigned)describe_only << 5 |
+                         (unsigned)distinct << 6 | (unsigned)keep_last << 7;
+
+        FileFingerprint fingerprint;
+        char* key = NULL;
+        if (file_fingerprint(filename, &fingerprint)) {
+            key = build_cache_key(arena, where_str, filter_pattern, select_str, sort_col, unique_str, eval_str,
+                                  hide_cols, format, limit, offset, delimiter, comment, flags);
+        }
+
+        if (key != NULL && result_cache_replay(cache_dir, &fingerprint, key)) {
+            flag_parser_free(parser);
+            arena_destroy(arena);
+            return EXIT_SUCCESS;
+        }
+        if (key != NULL) {
+            result_cache_begin(&capture, cache_dir, &fingerprint, key);
+        }
+    }
+
     // Initialize CSV reader
     CsvReader* reader = csv_reader_new(filename, 0);
     if (reader == NULL) {
         flag_parser_free(parser);
         arena_destroy(arena);
-        return EXIT_FAILURE;
+        return finish_capture(&capture, EXIT_FAILURE);
     }
 
     // Configure and parse CSV
@@ -1826,7 +2876,7 @@ int main(int argc, char* argv[]) {
         csv_reader_free(reader);
         flag_parser_free(parser);
         arena_destroy(arena);
-        return EXIT_FAILURE;
+        return finish_capture(&capture, EXIT_FAILURE);
     }
 
     size_t count = csv_reader_numrows(reader);
@@ -1835,12 +2885,36 @@ int main(int argc, char* argv[]) {
         csv_reader_free(reader);
         flag_parser_free(parser);
         arena_destroy(arena);
-        return EXIT_FAILURE;
+        return finish_capture(&capture, EXIT_FAILURE);
+    }
+
+    // Typed column cache over the data rows; columns are parsed on first use
+    size_t data_start = has_header ? 1 : 0;
+    ColumnCache cache = {0};
+    if (!column_cache_init(&cache, arena, rows + data_start, count - data_start, rows[0]->count)) {
+        csv_reader_free(reader);
+        flag_parser_free(parser);
+        arena_destroy(arena);
+        return finish_capture(&capture, EXIT_FAILURE);
+    }
+
+    // Zone maps describe the file order, so the index is applied before any sorting
+    if (use_index || bloom_str != NULL) {
+        ColumnSelection bloom_sel = {0};
+        const Row* header         = has_header ? rows[0] : NULL;
+        bool has_bloom_cols       = bloom_str != NULL && parse_column_selection(bloom_str, header, &bloom_sel);
+        apply_sidecar_index(filename, &config, &cache, has_bloom_cols ? &bloom_sel : NULL);
     }
 
-    // Sort if requested
-    if (sort_col != NULL) {
-        sort_rows(rows, count, has_header, sort_col, sort_desc);
+    // Computed columns join the header before names are resolved for sorting, selection and filtering
+    if (eval_str != NULL) {
+        rows = add_eval_columns(arena, &cache, rows, count, has_header, eval_str);
+        if (rows == NULL) {
+            csv_reader_free(reader);
+            flag_parser_free(parser);
+            arena_destroy(arena);
+            return finish_capture(&capture, EXIT_FAILURE);
+        }
     }
 
     // Parse column selection
@@ -1853,12 +2927,62 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // --distinct compares every column, --unique-by the listed ones
+    ColumnSelection unique_sel = {0};
+    UniqueRows unique          = {.cache = &cache, .keep_last = keep_last};
+    UniqueRows* unique_ptr     = NULL;
+    bool unique_ok             = true;
+    if (unique_str != NULL) {
+        if (distinct) {
+            fprintf(stderr, "Warning: --distinct is ignored with --unique-by\n");
+        }
+        unique_ok        = parse_column_selection(unique_str, has_header ? rows[0] : NULL, &unique_sel);
+        unique.cols      = unique_sel.indices;
+        unique.col_count = unique_sel.count;
+        unique_ptr       = &unique;
+        if (!unique_ok) {
+            fprintf(stderr, "Error: No valid columns in --unique-by '%s'\n", unique_str);
+        }
+    } else if (distinct) {
+        size_t* all_cols = ARENA_ALLOC_ARRAY(arena, size_t, cache.col_count > 0 ? cache.col_count : 1);
+        for (size_t c = 0; all_cols != NULL && c < cache.col_count; c++) {
+            all_cols[c] = c;
+        }
+        unique.cols      = all_cols;
+        unique.col_count = cache.col_count;
+        unique_ptr       = &unique;
+        unique_ok        = all_cols != NULL;
+        if (!unique_ok) {
+            fprintf(stderr, "Error: Memory allocation failed for --distinct\n");
+        }
+    }
+
+    // Queries stream their rows, so the last duplicate is not known until the end
+    if (keep_last && unique_ptr != NULL && queries_str != NULL) {
+        fprintf(stderr, "Error: --keep-last is not supported with --queries\n");
+        unique_ok = false;
+    }
+
+    if (!unique_ok) {
+        csv_reader_free(reader);
+        flag_parser_free(parser);
+        arena_destroy(arena);
+        return finish_capture(&capture, EXIT_FAILURE);
+    }
+
     // Parse WHERE clause
     WhereFilter where      = {0};
     WhereFilter* where_ptr = NULL;
     if (where_str != NULL) {
         if (parse_where_clause(arena, where_str, &where)) {
             where_ptr = &where;
+            // The key does not cover the contents of list files, so the result is not stored
+            if (uses_list_file(where.root)) {
+                finish_capture(&capture, EXIT_FAILURE);
+            }
+        } else {
+            // The rows are printed unfiltered; that output must never be replayed as the query's
+            finish_capture(&capture, EXIT_FAILURE);
         }
     }
 
@@ -1866,21 +2990,88 @@ int main(int argc, char* argv[]) {
         resolve_ast_indices(where_ptr->root, rows[0]);
     }
 
+    // Range conditions on columns the index knows to be sorted are binary-searched, not scanned
+    if (where_ptr != NULL) {
+        attach_sorted_ranges(&cache, where_ptr->root);
+    }
+
+    // With --cache, each condition's result is kept for later queries that repeat it
+    SidecarKey predicate_key;
+    bool cache_predicates = cache_dir != NULL && sidecar_key_init(&predicate_key, filename, &cache, delimiter, comment,
+                                                                  has_header);
+    if (where_ptr != NULL && cache_predicates) {
+        predicate_cache_attach(cache_dir, &predicate_key, eval_str, &cache, where_ptr->root);
+    }
+
+    if (queries_str != NULL) {
+        if (where_ptr != NULL) {
+            fprintf(stderr, "Warning: --where is ignored with --queries\n");
+        }
+
+        PrintConfig query_config = {.has_header     = has_header,
+                                    .format         = format,
+                                    .filter_pattern = filter_pattern,
+                                    .selection      = sel_ptr,
+                                    .unique         = unique_ptr,
+                                    .limit          = limit,
+                                    .offset         = offset};
+
+        // Queries stream rows in cache order, so the cache itself is sorted, before any selection is attached
+        if (sort_col != NULL) {
+            sort_cache_rows(&cache, has_header ? rows[0] : NULL, sort_col, sort_desc);
+        }
+
+        NamedQuery* queries = ARENA_ALLOC_ARRAY(arena, NamedQuery, MAX_QUERIES);
+        size_t num_queries  = queries != NULL ? load_queries(arena, queries_str, queries) : (size_t)-1;
+
+        for (size_t i = 0; num_queries != (size_t)-1 && i < num_queries; i++) {
+            if (has_header) {
+                resolve_ast_indices(queries[i].where.root, rows[0]);
+            }
+            attach_sorted_ranges(&cache, queries[i].where.root);
+            if (cache_predicates) {
+                predicate_cache_attach(cache_dir, &predicate_key, eval_str, &cache, queries[i].where.root);
+            }
+        }
+
+        bool ok = num_queries != (size_t)-1 && run_queries(rows, &cache, &query_config, queries, num_queries);
+
+        for (size_t i = 0; num_queries != (size_t)-1 && i < num_queries; i++) {
+            free_where_filter(&queries[i].where);
+        }
+        free_where_filter(where_ptr);
+        csv_reader_free(reader);
+        flag_parser_free(parser);
+        arena_destroy(arena);
+        return finish_capture(&capture, ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     if (count_only) {
-        size_t matched = count_filtered_rows(rows, count, has_header, filter_pattern, where_ptr);
-        printf("%zu\n", matched);
+        size_t matched = 0;
+        bool ok        = true;
+        if (unique_ptr != NULL) {
+            ok = count_unique_rows(arena, &cache, filter_pattern, where_ptr, unique_ptr, &matched);
+        } else {
+            matched = count_filtered_rows(&cache, filter_pattern, where_ptr);
+        }
+        if (ok) {
+            printf("%zu\n", matched);
+        }
+        free_where_filter(where_ptr);
         csv_reader_free(reader);
         flag_parser_free(parser);
         arena_destroy(arena);
-        return EXIT_SUCCESS;
+        return finish_capture(&capture, ok ? EXIT_SUCCESS : EXIT_FAILURE);
     }
 
     if (describe_only) {
-        print_describe_stats(rows, count, has_header, filter_pattern, where_ptr, sel_ptr, use_colors);
+        print_describe_stats(rows, count, has_header, &cache, filter_pattern, where_ptr, unique_ptr, sel_ptr,
+                             use_colors);
+        free_where_filter(where_ptr);
         csv_reader_free(reader);
         flag_parser_free(parser);
         arena_destroy(arena);
-        return EXIT_SUCCESS;
+        return finish_capture(&capture, EXIT_SUCCESS);
     }
 
     // Prepare print configuration
@@ -1891,16 +3082,20 @@ int main(int argc, char* argv[]) {
                                 .filter_pattern = filter_pattern,
                                 .where          = where_ptr,
                                 .selection      = sel_ptr,
+                                .unique         = unique_ptr,
+                                .sort           = sort_col,
+                                .sort_desc      = sort_desc,
                                 .limit          = limit,
                                 .offset         = offset};
 
     // Print the table
-    print_table(rows, count, &print_config);
+    print_table(rows, count, &cache, &print_config);
 
     // Cleanup
+    free_where_filter(where_ptr);
     csv_reader_free(reader);
     flag_parser_free(parser);
     arena_destroy(arena);
 
-    return EXIT_SUCCESS;
+    return finish_capture(&capture, EXIT_SUCCESS);
 }
@@ -0,0 +1,352 @@
+#include "../include/expr.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Finds a column index by name in the header row.
+ * (defined in csvq.c)
+ */
+extern ssize_t find_column_by_name(const Row* header, const char* name);
+
+/** Compiler state: a cursor over the text and the program being emitted. */
+typedef struct {
+    Arena* arena;
+    const char* p;
+    ExprInstr* code;
+    size_t length;
+    size_t capacity;
+    size_t registers;
+    bool failed;
+} ExprCompiler;
+
+static ExprOperand compile_sum(ExprCompiler* c, size_t reg);
+
+/**
+ * Skips whitespace and returns the next character without consuming it.
+ */
+static char peek(ExprCompiler* c) {
+    while (isspace((unsigned char)*c->p)) c->p++;
+    return *c->p;
+}
+
+/**
+ * Checks whether a character ends a bare name or a number.
+ */
+static bool is_delimiter(char ch) {
+    return ch == '\0' || isspace((unsigned char)ch) || strchr("+-*/()\"", ch) != NULL;
+}
+
+/**
+ * Folds a binary operation over two constants.
+ */
+static double fold(ExprOpcode op, double a, double b) {
+    switch (op) {
+        case EXPR_ADD:
+            return a + b;
+        case EXPR_SUB:
+            return a - b;
+        case EXPR_MUL:
+            return a * b;
+        case EXPR_DIV:
+            return a / b;
+    }
+    return NAN;
+}
+
+/**
+ * Emits `lhs op rhs` into register `reg`, or folds it when both operands are constants.
+ * @return The operand holding the result.
+ */
+static ExprOperand emit(ExprCompiler* c, ExprOpcode op, ExprOperand lhs, ExprOperand rhs, size_t reg) {
+    ExprOperand result = {.kind = EXPR_REGISTER, .index = reg};
+
+    if (lhs.kind == EXPR_CONSTANT && rhs.kind == EXPR_CONSTANT) {
+        result.kind     = EXPR_CONSTANT;
+        result.constant = fold(op, lhs.constant, rhs.constant);
+        return result;
+    }
+    if (c->length == c->capacity) {
+        c->failed = true;
+        return result;
+    }
+
+    c->code[c->length++] = (ExprInstr){.op = op, .target = reg, .lhs = lhs, .rhs = rhs};
+    if (reg + 1 > c->registers) {
+        c->registers = reg + 1;
+    }
+    return result;
+}
+
+/**
+ * Returns the first free register after an operand that may occupy `reg`.
+ */
+static size_t next_register(ExprOperand operand, size_t reg) {
+    return operand.kind == EXPR_REGISTER ? reg + 1 : reg;
+}
+
+/**
+ * primary := number | name | "quoted name" | '(' sum ')' | '-' primary
+ */
+static ExprOperand compile_primary(ExprCompiler* c, size_t reg) {
+    ExprOperand operand = {.kind = EXPR_CONSTANT};
+    char ch             = peek(c);
+
+    if (ch == '-' || ch == '+') {
+        c->p++;
+        ExprOperand inner = compile_primary(c, reg);
+        if (ch == '+') return inner;
+        return emit(c, EXPR_SUB, operand, inner, reg);  // -x is 0 - x
+    }
+
+    if (ch == '(') {
+        c->p++;
+        operand = compile_sum(c, reg);
+        if (peek(c) != ')') {
+            c->failed = true;
+        } else {
+            c->p++;
+        }
+        return operand;
+    }
+
+    const char* start = c->p;
+    const char* end   = NULL;
+    if (ch == '"') {
+        start++;
+        end = strchr(start, '"');
+        if (end == NULL) {
+            c->failed = true;
+            return operand;
+        }
+        c->p = end + 1;
+    } else {
+        if (isdigit((unsigned char)ch) || ch == '.') {
+            char* num_end;
+            double value = strtod(start, &num_end);
+            if (num_end != start && is_delimiter(*num_end)) {
+                c->p             = num_end;
+                operand.constant = value;
+                return operand;
+            }
+        }
+        end = start;
+        while (!is_delimiter(*end)) end++;
+        c->p = end;
+    }
+
+    size_t len = (size_t)(end - start);
+    if (len == 0) {
+        c->failed = true;
+        return operand;
+    }
+
+    operand.kind = EXPR_COLUMN;
+    operand.name = arena_alloc(c->arena, len + 1);
+    if (operand.name == NULL) {
+        c->failed = true;
+        return operand;
+    }
+    memcpy(operand.name, start, len);
+    operand.name[len] = '\0';
+    return operand;
+}
+
+/**
+ * product := primary (('*' | '/') primary)*
+ */
+static ExprOperand compile_product(ExprCompiler* c, size_t reg) {
+    ExprOperand lhs = compile_primary(c, reg);
+
+    for (char ch = peek(c); !c->failed && (ch == '*' || ch == '/'); ch = peek(c)) {
+        c->p++;
+        ExprOperand rhs = compile_primary(c, next_register(lhs, reg));
+        lhs             = emit(c, ch == '*' ? EXPR_MUL : EXPR_DIV, lhs, rhs, reg);
+    }
+    return lhs;
+}
+
+/**
+ * sum := product (('+' | '-') product)*
+ */
+static ExprOperand compile_sum(ExprCompiler* c, size_t reg) {
+    ExprOperand lhs = compile_product(c, reg);
+
+    for (char ch = peek(c); !c->failed && (ch == '+' || ch == '-'); ch = peek(c)) {
+        c->p++;
+        ExprOperand rhs = compile_product(c, next_register(lhs, reg));
+        lhs             = emit(c, ch == '+' ? EXPR_ADD : EXPR_SUB, lhs, rhs, reg);
+    }
+    return lhs;
+}
+
+/**
+ * Compiles an arithmetic expression into a register program.
+ */
+Expr* expr_compile(Arena* arena, const char* text) {
+    if (arena == NULL || text == NULL) {
+        return NULL;
+    }
+
+    // Every instruction consumes at least one operator character, so this bounds the program
+    ExprCompiler c = {.arena = arena, .p = text, .capacity = strlen(text)};
+    c.code         = ARENA_ALLOC_ARRAY(arena, ExprInstr, c.capacity > 0 ? c.capacity : 1);
+    if (c.code == NULL) {
+        return NULL;
+    }
+
+    ExprOperand result = compile_sum(&c, 0);
+    if (c.failed || peek(&c) != '\0' || result.kind != EXPR_REGISTER) {
+        return NULL;  // Syntax error, a lone name or a constant
+    }
+
+    Expr* expr = ARENA_ALLOC_ZERO(arena, Expr);
+    if (expr == NULL) {
+        return NULL;
+    }
+
+    expr->code      = c.code;
+    expr->length    = c.length;
+    expr->registers = c.registers;
+    expr->scratch   = ARENA_ALLOC_ARRAY(arena, double, c.registers * EXPR_BATCH_ROWS);
+    if (expr->scratch == NULL) {
+        return NULL;
+    }
+    return expr;
+}
+
+/**
+ * Resolves one operand's column name.
+ */
+static bool resolve_operand(ExprOperand* operand, const Row* header) {
+    if (operand->kind != EXPR_COLUMN) {
+        return true;
+    }
+
+    ssize_t idx = find_column_by_name(header, operand->name);
+    if (idx < 0) {
+        fprintf(stderr, "Warning: Column '%s' in expression not found in header.\n", operand->name);
+        return false;
+    }
+    operand->index = (size_t)idx;
+    return true;
+}
+
+/**
+ * Resolves the column names of a compiled expression against the header row.
+ */
+bool expr_resolve(Expr* expr, const Row* header) {
+    if (expr == NULL) {
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < expr->length; i++) {
+        ok &= resolve_operand(&expr->code[i].lhs, header);
+        ok &= resolve_operand(&expr->code[i].rhs, header);
+    }
+
+    expr->resolved = ok;
+    return ok;
+}
+
+/**
+ * Applies `op` element-wise. Vector/vector, vector/scalar and scalar/vector forms are
+ * kept as separate plain loops so the compiler can vectorize each of them.
+ */
+#define EXPR_APPLY(dst, a, a_vec, b, b_vec, n, op)                                    \
+    do {                                                                              \
+        if ((a_vec) && (b_vec)) {                                                     \
+            for (size_t i_ = 0; i_ < (n); i_++) (dst)[i_] = (a)[i_] op(b)[i_];        \
+        } else if (a_vec) {                                                           \
+            const double s_ = (b)[0];                                                 \
+            for (size_t i_ = 0; i_ < (n); i_++) (dst)[i_] = (a)[i_] op s_;            \
+        } else {                                                                      \
+            const double s_ = (a)[0];                                                 \
+            for (size_t i_ = 0; i_ < (n); i_++) (dst)[i_] = s_ op(b)[i_];             \
+        }                                                                             \
+    } while (0)
+
+/**
+ * Returns the values of an operand for the batch and whether they form a vector.
+ * Columns are read in place from the cache; their non-numeric cells are masked out of `valid`.
+ */
+static const double* operand_values(ColumnCache* cache, const Expr* expr, const ExprOperand* operand, size_t start,
+                                    size_t count, uint64_t* valid, bool* is_vector) {
+    *is_vector = true;
+
+    switch (operand->kind) {
+        case EXPR_REGISTER:
+            return expr->scratch + operand->index * EXPR_BATCH_ROWS;
+        case EXPR_CONSTANT:
+            *is_vector = false;
+            return &operand->constant;
+        case EXPR_COLUMN: {
+            const ColumnVector* vec = column_cache_get_block(cache, operand->index, start);
+            if (vec == NULL) {
+                return NULL;
+            }
+            for (size_t w = 0; w < BITMAP_WORDS(count); w++) {
+                valid[w] &= vec->numeric[start / 64 + w];
+            }
+            return vec->values + start;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Evaluates a resolved expression over a batch of rows.
+ */
+bool expr_eval_batch(ColumnCache* cache, const Expr* expr, size_t start, size_t count, double* out, uint64_t* valid) {
+    if (expr == NULL || !expr->resolved || count > EXPR_BATCH_ROWS) {
+        return false;
+    }
+
+    size_t words = BITMAP_WORDS(count);
+    for (size_t w = 0; w < words; w++) {
+        size_t n = count - w * 64;
+        valid[w] = n >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
+    }
+
+    for (size_t i = 0; i < expr->length; i++) {
+        const ExprInstr* in = &expr->code[i];
+        bool a_vec, b_vec;
+
+        const double* a = operand_values(cache, expr, &in->lhs, start, count, valid, &a_vec);
+        const double* b = operand_values(cache, expr, &in->rhs, start, count, valid, &b_vec);
+        if (a == NULL || b == NULL) {
+            return false;
+        }
+
+        // The last instruction writes straight into the caller's buffer
+        double* dst = (i + 1 == expr->length) ? out : expr->scratch + in->target * EXPR_BATCH_ROWS;
+        switch (in->op) {
+            case EXPR_ADD:
+                EXPR_APPLY(dst, a, a_vec, b, b_vec, count, +);
+                break;
+            case EXPR_SUB:
+                EXPR_APPLY(dst, a, a_vec, b, b_vec, count, -);
+                break;
+            case EXPR_MUL:
+                EXPR_APPLY(dst, a, a_vec, b, b_vec, count, *);
+                break;
+            case EXPR_DIV:
+                EXPR_APPLY(dst, a, a_vec, b, b_vec, count, /);
+                break;
+        }
+    }
+
+    // NaN (e.g. 0 / 0) compares unequal to everything, so treat it as missing
+    for (size_t w = 0; w < words; w++) {
+        size_t n      = (count - w * 64) < 64 ? (count - w * 64) : 64;
+        uint64_t nans = 0;
+        for (size_t j = 0; j < n; j++) {
+            nans |= (uint64_t)(out[w * 64 + j] != out[w * 64 + j]) << j;
+        }
+        valid[w] &= ~nans;
+    }
+    return true;
+}
@@ -0,0 +1,242 @@
+#include "../include/hash-set.h"
+#include <stdio.h>
+#include <string.h>
+#include "../include/ascii-fold.h"
+
+/** Grow when the table is more than 70% full. */
+#define MAX_LOAD_NUM 7
+#define MAX_LOAD_DEN 10
+
+/**
+ * Hashes `len` bytes after ASCII case folding (FNV-1a, never returns 0).
+ */
+uint64_t hash_bytes_nocase(const char* data, size_t len) {
+    uint64_t h = HASH_SEED;
+    for (size_t i = 0; i < len; i++) {
+        h ^= ascii_fold((unsigned char)data[i]);
+        h *= 1099511628211ULL;
+    }
+    return h != 0 ? h : 1;
+}
+
+/**
+ * Continues an FNV-1a hash over `len` bytes.
+ */
+uint64_t hash_bytes(uint64_t h, const void* data, size_t len) {
+    const unsigned char* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * Allocates a zeroed slot table.
+ */
+static StringSetSlot* alloc_slots(Arena* arena, size_t capacity) {
+    StringSetSlot* slots = ARENA_ALLOC_ARRAY(arena, StringSetSlot, capacity);
+    if (slots != NULL) {
+        memset(slots, 0, sizeof(StringSetSlot) * capacity);
+    }
+    return slots;
+}
+
+/**
+ * Creates an empty set sized for roughly `expected` keys.
+ */
+StringSet* string_set_create(Arena* arena, size_t expected) {
+    StringSet* set = ARENA_ALLOC_ZERO(arena, StringSet);
+    if (set == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for hash set\n");
+        return NULL;
+    }
+
+    size_t capacity = 16;
+    while (capacity * MAX_LOAD_NUM < expected * MAX_LOAD_DEN) {
+        capacity <<= 1;
+    }
+
+    set->arena    = arena;
+    set->capacity = capacity;
+    set->slots    = alloc_slots(arena, capacity);
+    if (set->slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for hash set\n");
+        return NULL;
+    }
+    return set;
+}
+
+/**
+ * Finds the slot holding `key`, or the empty slot where it would go.
+ */
+static StringSetSlot* find_slot(StringSetSlot* slots, size_t capacity, uint64_t hash, const char* key, size_t len) {
+    size_t mask = capacity - 1;
+    size_t i    = (size_t)hash & mask;
+
+    for (;;) {
+        StringSetSlot* slot = &slots[i];
+        if (slot->hash == 0) {
+            return slot;
+        }
+        if (slot->hash == hash && slot->len == len && ascii_equal_nocase(slot->key, key, len)) {
+            return slot;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+/**
+ * Doubles the table and re-inserts every key.
+ */
+static bool grow(StringSet* set) {
+    size_t capacity      = set->capacity * 2;
+    StringSetSlot* slots = alloc_slots(set->arena, capacity);
+    if (slots == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < set->capacity; i++) {
+        const StringSetSlot* old = &set->slots[i];
+        if (old->hash != 0) {
+            *find_slot(slots, capacity, old->hash, old->key, old->len) = *old;
+        }
+    }
+
+    set->slots    = slots;
+    set->capacity = capacity;
+    return true;
+}
+
+/**
+ * Adds a copy of a key to the set (duplicates are ignored).
+ */
+bool string_set_add(StringSet* set, const char* key, size_t len) {
+    if ((set->count + 1) * MAX_LOAD_DEN > set->capacity * MAX_LOAD_NUM && !grow(set)) {
+        fprintf(stderr, "Error: Memory allocation failed for hash set\n");
+        return false;
+    }
+
+    uint64_t hash       = hash_bytes_nocase(key, len);
+    StringSetSlot* slot = find_slot(set->slots, set->capacity, hash, key, len);
+    if (slot->hash != 0) {
+        return true;  // Already present
+    }
+
+    char* copy = arena_alloc(set->arena, len + 1);
+    if (copy == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for hash set key\n");
+        return false;
+    }
+    memcpy(copy, key, len);
+    copy[len] = '\0';
+
+    slot->hash = hash;
+    slot->key  = copy;
+    slot->len  = len;
+    set->count++;
+    return true;
+}
+
+/**
+ * Checks whether the set contains a key (ASCII case-insensitive).
+ */
+bool string_set_contains(const StringSet* set, const char* key, size_t len) {
+    uint64_t hash = hash_bytes_nocase(key, len);
+    return find_slot(set->slots, set->capacity, hash, key, len)->hash != 0;
+}
+
+/**
+ * Creates an empty row set sized for roughly `expected` keys.
+ */
+RowSet* row_set_create(Arena* arena, size_t expected, RowEqualFn equal, const void* ctx) {
+    RowSet* set = ARENA_ALLOC_ZERO(arena, RowSet);
+    if (set == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for row set\n");
+        return NULL;
+    }
+
+    size_t capacity = 16;
+    while (capacity * MAX_LOAD_NUM < expected * MAX_LOAD_DEN) {
+        capacity <<= 1;
+    }
+
+    set->arena    = arena;
+    set->capacity = capacity;
+    set->equal    = equal;
+    set->ctx      = ctx;
+    set->slots    = ARENA_ALLOC_ARRAY(arena, RowSetSlot, capacity);
+    if (set->slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for row set\n");
+        return NULL;
+    }
+    memset(set->slots, 0, sizeof(RowSetSlot) * capacity);
+    return set;
+}
+
+/**
+ * Finds the slot holding the key of `row`, or the empty slot where it would go.
+ */
+static RowSetSlot* find_row_slot(const RowSet* set, uint64_t hash, size_t row) {
+    size_t mask = set->capacity - 1;
+    size_t i    = (size_t)hash & mask;
+
+    for (;;) {
+        RowSetSlot* slot = &set->slots[i];
+        if (slot->hash == 0) {
+            return slot;
+        }
+        if (slot->hash == hash && set->equal(set->ctx, slot->row, row)) {
+            return slot;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+/**
+ * Doubles the table and re-inserts every row. Stored keys are distinct, so no rows are compared.
+ */
+static bool grow_rows(RowSet* set) {
+    size_t capacity   = set->capacity * 2;
+    RowSetSlot* slots = ARENA_ALLOC_ARRAY(set->arena, RowSetSlot, capacity);
+    if (slots == NULL) {
+        return false;
+    }
+    memset(slots, 0, sizeof(RowSetSlot) * capacity);
+
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < set->capacity; i++) {
+        const RowSetSlot* old = &set->slots[i];
+        if (old->hash != 0) {
+            size_t j = (size_t)old->hash & mask;
+            while (slots[j].hash != 0) {
+                j = (j + 1) & mask;
+            }
+            slots[j] = *old;
+        }
+    }
+
+    set->slots    = slots;
+    set->capacity = capacity;
+    return true;
+}
+
+/**
+ * Adds the key of `row` unless a row with the same key is already in the set.
+ */
+bool row_set_add(RowSet* set, uint64_t hash, size_t row, bool* added) {
+    if ((set->count + 1) * MAX_LOAD_DEN > set->capacity * MAX_LOAD_NUM && !grow_rows(set)) {
+        fprintf(stderr, "Error: Memory allocation failed for row set\n");
+        return false;
+    }
+
+    hash             = hash != 0 ? hash : 1;  // 0 marks empty slots
+    RowSetSlot* slot = find_row_slot(set, hash, row);
+    *added           = slot->hash == 0;
+    if (*added) {
+        slot->hash = hash;
+        slot->row  = row;
+        set->count++;
+    }
+    return true;
+}
@@ -0,0 +1,382 @@
+#include "../include/predicate-cache.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/expr.h"
+#include "../include/hash-set.h"
+#include "../include/result-cache.h"
+#include "../include/where-parser.h"
+
+/** Entry magic and layout version. */
+#define PREDICATE_MAGIC "CSVQSEL2"
+
+/** Most positions a block lists before it is stored as a bitmap (the Roaring threshold). */
+#define ARRAY_MAX 4096
+
+_Static_assert(ZONE_ROWS <= 65536, "block positions are stored as 16-bit offsets");
+
+/** How one ZONE_ROWS block of a selection is stored. */
+typedef enum {
+    BLOCK_EMPTY    = 0,  // No row selected; no payload
+    BLOCK_FULL     = 1,  // Every row selected; no payload
+    BLOCK_ARRAY    = 2,  // `count` uint16 offsets of the selected rows
+    BLOCK_INVERTED = 3,  // `count` uint16 offsets of the rejected rows
+    BLOCK_BITMAP   = 4,  // BITMAP_WORDS(block rows) words
+} BlockKind;
+
+/** Fixed-size entry header, followed by the condition key and one block after another. */
+typedef struct {
+    char magic[8];
+    uint32_t block_rows;  // ZONE_ROWS at build time
+    uint32_t reserved;
+    FileFingerprint file;
+    uint64_t row_count;
+    uint64_t col_count;
+    uint64_t key_len;
+    uint8_t delimiter;
+    uint8_t comment;
+    uint8_t has_header;
+    uint8_t padding[5];
+} PredicateHeader;
+
+/** Header preceding each block payload. */
+typedef struct {
+    uint32_t kind;   // BlockKind
+    uint32_t count;  // Offsets that follow (array kinds only)
+} BlockHeader;
+
+/** State shared while walking one where tree. */
+typedef struct {
+    const char* dir;
+    const SidecarKey* key;
+    const char* context;
+    ColumnCache* cache;
+    bool warned;  // Write failure already reported
+} AttachState;
+
+/**
+ * Formats everything that decides a condition's result; snprintf() semantics.
+ */
+static int format_clause_key(char* buf, size_t size, const WhereClause* wc, const char* context) {
+    const char* expr  = wc->expr != NULL ? wc->column_name : "";
+    const char* value = wc->value != NULL ? wc->value : "";
+
+    return snprintf(buf, size, "op=%d col=%zu expr=%zu:%s numeric=%d,%d,%d bounds=%.17g,%.17g,%lld,%lld,%d,%d "
+                               "eval=%zu:%s value=%s",
+                    (int)wc->op, wc->column_idx, strlen(expr), expr, wc->is_numeric, wc->has_number, wc->is_time,
+                    wc->number, wc->upper, (long long)wc->time, (long long)wc->time_upper, wc->exclusive_lower,
+                    wc->exclusive_upper, strlen(context), context, value);
+}
+
+/**
+ * Builds the cache key of a condition.
+ * @return The key, or NULL if the condition can't be cached.
+ */
+static char* clause_key(Arena* arena, const WhereClause* wc, const char* context) {
+    bool resolved = wc->expr != NULL ? wc->expr->resolved : wc->column_idx != (size_t)-1;
+
+    // A value list read from a file may change while the CSV stays the same
+    if (!resolved || (wc->op == OP_IN && wc->value != NULL && wc->value[0] == '@')) {
+        return NULL;
+    }
+
+    int len = format_clause_key(NULL, 0, wc, context);
+    if (len < 0) {
+        return NULL;
+    }
+
+    char* key = arena_alloc(arena, (size_t)len + 1);
+    if (key != NULL) {
+        format_clause_key(key, (size_t)len + 1, wc, context);
+    }
+    return key;
+}
+
+/**
+ * Builds "<dir>/<hash of file state and condition><suffix>" in a malloc'd buffer.
+ */
+static char* entry_path(const char* dir, const SidecarKey* key, const char* clause, const char* suffix) {
+    uint64_t h = HASH_SEED;
+    h          = hash_bytes(h, &key->file, sizeof(key->file));
+    h          = hash_bytes(h, &key->row_count, sizeof(key->row_count));
+    h          = hash_bytes(h, &key->col_count, sizeof(key->col_count));
+    h          = hash_bytes(h, &key->delimiter, 1);
+    h          = hash_bytes(h, &key->comment, 1);
+    h          = hash_bytes(h, &key->has_header, 1);
+    h          = hash_bytes(h, clause, strlen(clause));
+    return cache_entry_path(dir, h, PREDICATE_CACHE_SUFFIX, suffix);
+}
+
+/**
+ * Checks whether a stored header was built from the same file, settings and condition length.
+ */
+static bool header_matches(const PredicateHeader* hdr, const SidecarKey* key, size_t clause_len) {
+    return memcmp(hdr->magic, PREDICATE_MAGIC, 8) == 0 && hdr->block_rows == ZONE_ROWS &&
+           file_fingerprint_equal(&hdr->file, &key->file) && hdr->row_count == key->row_count &&
+           hdr->col_count == key->col_count && hdr->delimiter == key->delimiter && hdr->comment == key->comment &&
+           hdr->has_header == key->has_header && hdr->key_len == clause_len;
+}
+
+/**
+ * Selects the first `rows` bits of a block.
+ */
+static void fill_block(uint64_t* bits, size_t rows) {
+    size_t words = BITMAP_WORDS(rows);
+    for (size_t w = 0; w < words; w++) {
+        size_t n = (rows - w * 64) < 64 ? (rows - w * 64) : 64;
+        bits[w]  = n == 64 ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
+    }
+}
+
+/**
+ * Lists the offsets of the set (or, with `invert`, clear) bits among the first `rows` of a block.
+ * @return Number of offsets written.
+ */
+static size_t collect_offsets(const uint64_t* bits, size_t rows, bool invert, uint16_t* out) {
+    size_t count = 0;
+    for (size_t w = 0; w < BITMAP_WORDS(rows); w++) {
+        size_t n      = (rows - w * 64) < 64 ? (rows - w * 64) : 64;
+        uint64_t mask = n == 64 ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
+        uint64_t word = (invert ? ~bits[w] : bits[w]) & mask;
+
+        while (word != 0) {
+            out[count++] = (uint16_t)(w * 64 + bitmap_lowest(word));
+            word &= word - 1;
+        }
+    }
+    return count;
+}
+
+/**
+ * Reads a stored selection into `bits` (file order, zeroed by the caller).
+ * @return true if the entry matches and decoded cleanly.
+ */
+static bool read_selection(FILE* f, const SidecarKey* key, const char* clause, uint64_t* bits) {
+    PredicateHeader hdr;
+    size_t clause_len = strlen(clause);
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 || !header_matches(&hdr, key, clause_len)) {
+        return false;
+    }
+
+    char* stored = malloc(clause_len + 1);
+    bool ok      = stored != NULL && fread(stored, 1, clause_len, f) == clause_len;
+    ok           = ok && memcmp(stored, clause, clause_len) == 0;
+    free(stored);
+
+    uint16_t* offsets = malloc(sizeof(uint16_t) * ARRAY_MAX);
+    ok                = ok && offsets != NULL;
+
+    for (size_t base = 0; ok && base < key->row_count; base += ZONE_ROWS) {
+        size_t rows    = key->row_count - base < ZONE_ROWS ? key->row_count - base : ZONE_ROWS;
+        uint64_t* dst  = bits + base / 64;
+        BlockHeader bh = {0};
+
+        ok = fread(&bh, sizeof(bh), 1, f) == 1;
+        if (!ok) break;
+
+        switch (bh.kind) {
+            case BLOCK_EMPTY:
+                break;
+            case BLOCK_FULL:
+                fill_block(dst, rows);
+                break;
+            case BLOCK_ARRAY:
+            case BLOCK_INVERTED:
+                ok = bh.count <= ARRAY_MAX && fread(offsets, sizeof(uint16_t), bh.count, f) == bh.count;
+                if (ok && bh.kind == BLOCK_INVERTED) {
+                    fill_block(dst, rows);
+                }
+                for (size_t i = 0; ok && i < bh.count; i++) {
+                    ok = offsets[i] < rows;
+                    if (ok && bh.kind == BLOCK_ARRAY) {
+                        bitmap_set(dst, offsets[i]);
+                    } else if (ok) {
+                        bitmap_clear(dst, offsets[i]);
+                    }
+                }
+                break;
+            case BLOCK_BITMAP:
+                ok = fread(dst, sizeof(uint64_t), BITMAP_WORDS(rows), f) == BITMAP_WORDS(rows);
+                break;
+            default:
+                ok = false;
+                break;
+        }
+    }
+
+    free(offsets);
+    return ok;
+}
+
+/**
+ * Writes a selection (file order) as a new entry.
+ * The entry is written to `tmp_path` first and moved into place by replace_file().
+ */
+static bool write_selection(const char* path, const char* tmp_path, const SidecarKey* key, const char* clause,
+                            const uint64_t* bits) {
+    FILE* f = fopen(tmp_path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+
+    PredicateHeader hdr = {0};
+    memcpy(hdr.magic, PREDICATE_MAGIC, 8);
+    hdr.block_rows = ZONE_ROWS;
+    hdr.file       = key->file;
+    hdr.row_count  = key->row_count;
+    hdr.col_count  = key->col_count;
+    hdr.key_len    = strlen(clause);
+    hdr.delimiter  = key->delimiter;
+    hdr.comment    = key->comment;
+    hdr.has_header = key->has_header;
+
+    uint16_t* offsets = malloc(sizeof(uint16_t) * ARRAY_MAX);
+    bool ok           = offsets != NULL && fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+              fwrite(clause, 1, hdr.key_len, f) == hdr.key_len;
+
+    for (size_t base = 0; ok && base < key->row_count; base += ZONE_ROWS) {
+        size_t rows         = key->row_count - base < ZONE_ROWS ? key->row_count - base : ZONE_ROWS;
+        size_t words        = BITMAP_WORDS(rows);
+        const uint64_t* src = bits + base / 64;
+
+        size_t selected = 0;
+        for (size_t w = 0; w < words; w++) {
+            selected += bitmap_popcount(src[w]);
+        }
+
+        // Sparse and dense blocks list their exceptions; the rest keep the bitmap
+        BlockHeader bh = {.kind = BLOCK_BITMAP};
+        if (selected == 0) {
+            bh.kind = BLOCK_EMPTY;
+        } else if (selected == rows) {
+            bh.kind = BLOCK_FULL;
+        } else if (selected <= ARRAY_MAX) {
+            bh.kind  = BLOCK_ARRAY;
+            bh.count = (uint32_t)collect_offsets(src, rows, false, offsets);
+        } else if (rows - selected <= ARRAY_MAX) {
+            bh.kind  = BLOCK_INVERTED;
+            bh.count = (uint32_t)collect_offsets(src, rows, true, offsets);
+        }
+
+        ok = fwrite(&bh, sizeof(bh), 1, f) == 1;
+        if (ok && bh.kind == BLOCK_BITMAP) {
+            ok = fwrite(src, sizeof(uint64_t), words, f) == words;
+        } else if (ok && bh.count > 0) {
+            ok = fwrite(offsets, sizeof(uint16_t), bh.count, f) == bh.count;
+        }
+    }
+
+    free(offsets);
+    ok = fclose(f) == 0 && ok;
+    return replace_file(tmp_path, path, ok);
+}
+
+/**
+ * Loads a stored selection into `bits` (current row order).
+ * @param saved Scratch bitmap for the file order; may be `bits` itself while the rows are in file order.
+ * @return true if the cache held the condition.
+ */
+static bool load_selection(const char* path, const SidecarKey* key, const char* clause, const ColumnCache* cache,
+                           uint64_t* bits, uint64_t* saved) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+
+    memset(saved, 0, sizeof(uint64_t) * BITMAP_WORDS(cache->row_count));
+    bool ok = read_selection(f, key, clause, saved);
+    fclose(f);
+
+    if (ok && cache->order != NULL) {
+        memset(bits, 0, sizeof(uint64_t) * BITMAP_WORDS(cache->row_count));
+        for (size_t r = 0; r < cache->row_count; r++) {
+            if (bitmap_test(saved, cache->order[r])) bitmap_set(bits, r);
+        }
+    }
+    return ok;
+}
+
+/**
+ * Evaluates a condition over every row into `bits` (current row order) and stores it in file order.
+ */
+static void compute_selection(AttachState* st, const WhereClause* wc, const char* clause, const char* path,
+                              const char* tmp_path, uint64_t* bits, uint64_t* saved) {
+    ColumnCache* cache = st->cache;
+    evaluate_clause_all(cache, wc, bits);
+
+    if (cache->order != NULL) {
+        memset(saved, 0, sizeof(uint64_t) * BITMAP_WORDS(cache->row_count));
+        for (size_t r = 0; r < cache->row_count; r++) {
+            if (bitmap_test(bits, r)) bitmap_set(saved, cache->order[r]);
+        }
+    }
+
+    if (!write_selection(path, tmp_path, st->key, clause, saved) && !st->warned) {
+        fprintf(stderr, "Warning: Cannot write to cache directory '%s'; conditions not cached\n", st->dir);
+        st->warned = true;
+    }
+}
+
+/**
+ * Loads or computes the selection of one condition and attaches it.
+ */
+static void attach_clause(AttachState* st, WhereClause* wc) {
+    ColumnCache* cache = st->cache;
+    size_t words       = BITMAP_WORDS(cache->row_count);
+
+    char* clause = clause_key(cache->arena, wc, st->context != NULL ? st->context : "");
+    if (clause == NULL) {
+        return;
+    }
+
+    char* path      = entry_path(st->dir, st->key, clause, "");
+    char* tmp_path  = entry_path(st->dir, st->key, clause, ".tmp");
+    uint64_t* bits  = ARENA_ALLOC_ARRAY(cache->arena, uint64_t, words);
+    uint64_t* saved = cache->order != NULL ? malloc(sizeof(uint64_t) * words) : bits;  // File order
+
+    if (path != NULL && tmp_path != NULL && bits != NULL && saved != NULL) {
+        if (!load_selection(path, st->key, clause, cache, bits, saved)) {
+            compute_selection(st, wc, clause, path, tmp_path, bits, saved);
+        }
+        wc->selection = bits;
+    }
+
+    if (saved != bits) {
+        free(saved);
+    }
+    free(path);
+    free(tmp_path);
+}
+
+/**
+ * Walks the where tree, attaching a selection to each condition.
+ */
+static void attach_node(AttachState* st, ASTNode* node) {
+    if (node == NULL) {
+        return;
+    }
+    if (node->type == NODE_LOGIC) {
+        attach_node(st, node->left);
+        attach_node(st, node->right);
+    } else if (node->clause->selection == NULL && !node->clause->has_range) {
+        attach_clause(st, node->clause);  // A binary-searched row range beats any bitmap
+    }
+}
+
+/**
+ * Gives every resolved condition of a where tree a precomputed selection.
+ */
+void predicate_cache_attach(const char* dir, const SidecarKey* key, const char* context, ColumnCache* cache,
+                            ASTNode* root) {
+    if (dir == NULL || key == NULL || cache == NULL || root == NULL || cache->row_count == 0) {
+        return;
+    }
+    if (!result_cache_make_dir(dir)) {
+        fprintf(stderr, "Warning: Cannot create cache directory '%s'; conditions not cached\n", dir);
+        return;
+    }
+
+    AttachState st = {.dir = dir, .key = key, .context = context, .cache = cache};
+    attach_node(&st, root);
+}
@@ -0,0 +1,1006 @@
+#include "../include/regex-dfa.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Largest bound accepted in {m,n}. */
+#define MAX_REPEAT 1000
+
+/** Upper bound on NFA size, to keep compiled patterns (and their DFA states) small. */
+#define MAX_NFA_STATES 65536
+
+/** Number of DFA states kept before the cache is flushed and rebuilt on demand. */
+#define MAX_DFA_STATES 4096
+
+/** Longest required literal kept for the prefilter. */
+#define MAX_LITERAL 64
+
+// =============================================================================
+// TYPES
+// =============================================================================
+
+/** Set of byte values. */
+typedef struct {
+    uint64_t bits[4];
+} ByteSet;
+
+/** Parsed pattern node. */
+typedef enum { AST_EMPTY, AST_CLASS, AST_CONCAT, AST_ALT, AST_REPEAT, AST_BEGIN, AST_END } AstKind;
+
+typedef struct {
+    AstKind kind;
+    int left;   // First child (CONCAT, ALT, REPEAT)
+    int right;  // Second child (CONCAT, ALT)
+    int min;    // REPEAT lower bound
+    int max;    // REPEAT upper bound, -1 for unbounded
+    int cls;    // CLASS byte set index
+} AstNode;
+
+/** Thompson NFA state. */
+typedef enum { NFA_CLASS, NFA_SPLIT, NFA_BEGIN, NFA_END, NFA_MATCH } NfaKind;
+
+typedef struct {
+    NfaKind kind;
+    int out;   // Next state
+    int out1;  // Second branch (SPLIT)
+    int cls;   // Byte set index (CLASS)
+} NfaState;
+
+/** Lazily built DFA state: a sorted set of NFA states plus its transitions. */
+typedef struct {
+    int* states;        // Sorted NFA CLASS/END/MATCH states
+    int count;          // Number of NFA states
+    bool match;         // Contains the MATCH state
+    bool match_at_end;  // Matches if the input ends here ('$' satisfied)
+    int32_t* next;      // Transition per byte class, -1 if not built yet
+} DfaState;
+
+/** Required-literal analysis of a node (see analyze_literals). */
+typedef struct {
+    bool exact;                 // Node only ever matches `exact_text`
+    char exact_text[MAX_LITERAL];
+    size_t exact_len;
+    char prefix[MAX_LITERAL];   // Every match starts with this
+    size_t prefix_len;
+    char suffix[MAX_LITERAL];   // Every match ends with this
+    size_t suffix_len;
+    char best[MAX_LITERAL];     // Longest literal found inside every match
+    size_t best_len;
+} LiteralInfo;
+
+struct Regex {
+    bool nocase;       // (?i) was given
+    bool has_anchors;  // Pattern uses ^ or $
+
+    AstNode* ast;
+    int ast_count, ast_cap;
+    ByteSet* sets;
+    int set_count, set_cap;
+
+    NfaState* nfa;
+    int nfa_count, nfa_cap;
+    int nfa_start;
+
+    uint8_t byte_class[256];  // Byte -> equivalence class
+    int num_byte_classes;
+
+    DfaState* dfa;
+    int dfa_count, dfa_cap;
+    int* table;  // Open-addressing table of DFA state indices, -1 = empty
+    size_t table_cap;
+    int dfa_start;     // DFA state at position 0, -1 if not built
+    bool empty_match;  // The empty input matches (set with dfa_start)
+
+    int* stack;      // Closure work stack
+    uint32_t* mark;  // Closure visited marks (generation numbers)
+    uint32_t mark_gen;
+    int* set_buf;  // Scratch NFA state set
+    int set_len;
+
+    char literal[MAX_LITERAL];  // Required literal for the prefilter
+    size_t literal_len;
+    bool literal_only;  // The pattern is exactly `literal`, no DFA needed
+};
+
+/** Recursive-descent parser state. */
+typedef struct {
+    Regex* re;
+    const char* p;
+    const char* error;
+} Parser;
+
+// =============================================================================
+// BYTE SETS
+// =============================================================================
+
+static inline void set_add(ByteSet* s, unsigned c) { s->bits[c >> 6] |= (uint64_t)1 << (c & 63); }
+
+static inline bool set_has(const ByteSet* s, unsigned c) { return (s->bits[c >> 6] >> (c & 63)) & 1u; }
+
+static inline unsigned char fold_ascii(unsigned char c) { return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c; }
+
+/**
+ * Adds a byte, plus its other ASCII case when matching case-insensitively.
+ */
+static void set_add_char(ByteSet* s, unsigned char c, bool nocase) {
+    set_add(s, c);
+    if (nocase) {
+        if (c >= 'a' && c <= 'z') set_add(s, c - 32u);
+        if (c >= 'A' && c <= 'Z') set_add(s, c + 32u);
+    }
+}
+
+static void set_add_range(ByteSet* s, unsigned char lo, unsigned char hi, bool nocase) {
+    for (unsigned c = lo; c <= hi; c++) {
+        set_add_char(s, (unsigned char)c, nocase);
+    }
+}
+
+static void set_negate(ByteSet* s) {
+    for (int i = 0; i < 4; i++) s->bits[i] = ~s->bits[i];
+}
+
+static void set_union(ByteSet* dst, const ByteSet* src) {
+    for (int i = 0; i < 4; i++) dst->bits[i] |= src->bits[i];
+}
+
+static int set_count_bits(const ByteSet* s) {
+    int n = 0;
+    for (int i = 0; i < 4; i++) n += __builtin_popcountll(s->bits[i]);
+    return n;
+}
+
+// =============================================================================
+// PARSER
+// =============================================================================
+
+static int new_ast(Parser* ps, AstKind kind) {
+    Regex* re = ps->re;
+    if (re->ast_count == re->ast_cap) {
+        int cap       = re->ast_cap ? re->ast_cap * 2 : 32;
+        AstNode* grow = realloc(re->ast, sizeof(AstNode) * (size_t)cap);
+        if (!grow) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        re->ast     = grow;
+        re->ast_cap = cap;
+    }
+
+    AstNode* n = &re->ast[re->ast_count];
+    memset(n, 0, sizeof(*n));
+    n->kind  = kind;
+    n->left  = -1;
+    n->right = -1;
+    n->cls   = -1;
+    return re->ast_count++;
+}
+
+static int new_class_node(Parser* ps, const ByteSet* set) {
+    Regex* re = ps->re;
+    if (re->set_count == re->set_cap) {
+        int cap       = re->set_cap ? re->set_cap * 2 : 16;
+        ByteSet* grow = realloc(re->sets, sizeof(ByteSet) * (size_t)cap);
+        if (!grow) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        re->sets    = grow;
+        re->set_cap = cap;
+    }
+    re->sets[re->set_count] = *set;
+
+    int node = new_ast(ps, AST_CLASS);
+    if (node >= 0) re->ast[node].cls = re->set_count++;
+    return node;
+}
+
+static int new_binary(Parser* ps, AstKind kind, int left, int right) {
+    int node = new_ast(ps, kind);
+    if (node >= 0) {
+        ps->re->ast[node].left  = left;
+        ps->re->ast[node].right = right;
+    }
+    return node;
+}
+
+/**
+ * Parses the character after a backslash into a set. Shared by atoms and brackets.
+ */
+static bool parse_escape(Parser* ps, ByteSet* set) {
+    bool nocase     = ps->re->nocase;
+    unsigned char c = (unsigned char)*ps->p;
+    if (c == '\0') {
+        ps->error = "trailing backslash";
+        return false;
+    }
+    ps->p++;
+
+    ByteSet tmp = {{0}};
+    switch (c) {
+        case 'd':
+        case 'D':
+            set_add_range(&tmp, '0', '9', false);
+            break;
+        case 'w':
+        case 'W':
+            set_add_range(&tmp, 'a', 'z', false);
+            set_add_range(&tmp, 'A', 'Z', false);
+            set_add_range(&tmp, '0', '9', false);
+            set_add(&tmp, '_');
+            break;
+        case 's':
+        case 'S':
+            set_add(&tmp, ' ');
+            set_add_range(&tmp, '\t', '\r', false);
+            break;
+        case 't':
+            set_add(&tmp, '\t');
+            break;
+        case 'n':
+            set_add(&tmp, '\n');
+            break;
+        case 'r':
+            set_add(&tmp, '\r');
+            break;
+        case 'f':
+            set_add(&tmp, '\f');
+            break;
+        case 'v':
+            set_add(&tmp, '\v');
+            break;
+        default:
+            set_add_char(&tmp, c, nocase);
+            break;
+    }
+
+    if (c == 'D' || c == 'W' || c == 'S') set_negate(&tmp);
+    set_union(set, &tmp);
+    return true;
+}
+
+/**
+ * Parses a bracket expression; the opening '[' has been consumed.
+ */
+static int parse_bracket(Parser* ps) {
+    ByteSet set = {{0}};
+    bool negate = false;
+    bool nocase = ps->re->nocase;
+
+    if (*ps->p == '^') {
+        negate = true;
+        ps->p++;
+    }
+
+    bool first = true;
+    while (*ps->p != ']' || first) {
+        if (*ps->p == '\0') {
+            ps->error = "missing ']'";
+            return -1;
+        }
+        first = false;
+
+        if (*ps->p == '\\') {
+            ps->p++;
+            if (!parse_escape(ps, &set)) return -1;
+            continue;
+        }
+
+        unsigned char lo = (unsigned char)*ps->p++;
+        if (*ps->p == '-' && ps->p[1] != ']' && ps->p[1] != '\0') {
+            unsigned char hi = (unsigned char)ps->p[1];
+            ps->p += 2;
+            if (hi < lo) {
+                ps->error = "invalid range in class";
+                return -1;
+            }
+            set_add_range(&set, lo, hi, nocase);
+        } else {
+            set_add_char(&set, lo, nocase);
+        }
+    }
+    ps->p++;  // ']'
+
+    if (negate) set_negate(&set);
+    return new_class_node(ps, &set);
+}
+
+static int parse_alternation(Parser* ps);
+
+/**
+ * Parses a single atom: group, class, '.', anchor, escape or literal.
+ */
+static int parse_atom(Parser* ps) {
+    unsigned char c = (unsigned char)*ps->p;
+    ByteSet set     = {{0}};
+
+    switch (c) {
+        case '(': {
+            ps->p++;
+            if (ps->p[0] == '?' && ps->p[1] == ':') ps->p += 2;
+            int inner = parse_alternation(ps);
+            if (inner < 0) return -1;
+            if (*ps->p != ')') {
+                ps->error = "missing ')'";
+                return -1;
+            }
+            ps->p++;
+            return inner;
+        }
+        case '[':
+            ps->p++;
+            return parse_bracket(ps);
+        case '.':
+            ps->p++;
+            set_negate(&set);
+            set.bits['\n' >> 6] &= ~((uint64_t)1 << ('\n' & 63));
+            return new_class_node(ps, &set);
+        case '^':
+            ps->p++;
+            ps->re->has_anchors = true;
+            return new_ast(ps, AST_BEGIN);
+        case '$':
+            ps->p++;
+            ps->re->has_anchors = true;
+            return new_ast(ps, AST_END);
+        case '\\':
+            ps->p++;
+            if (!parse_escape(ps, &set)) return -1;
+            return new_class_node(ps, &set);
+        case '*':
+        case '+':
+        case '?':
+            ps->error = "nothing to repeat";
+            return -1;
+        default:
+            ps->p++;
+            set_add_char(&set, c, ps->re->nocase);
+            return new_class_node(ps, &set);
+    }
+}
+
+/**
+ * Parses a "{m}", "{m,}" or "{m,n}" bound. Returns false (without consuming) if the
+ * text is not a valid bound, in which case '{' is a literal.
+ */
+static bool parse_bound(Parser* ps, int* min, int* max) {
+    const char* p = ps->p + 1;
+    if (*p < '0' || *p > '9') return false;
+
+    long lo = 0;
+    while (*p >= '0' && *p <= '9' && lo <= MAX_REPEAT) lo = lo * 10 + (*p++ - '0');
+
+    long hi = lo;
+    if (*p == ',') {
+        p++;
+        if (*p == '}') {
+            hi = -1;
+        } else {
+            if (*p < '0' || *p > '9') return false;
+            hi = 0;
+            while (*p >= '0' && *p <= '9' && hi <= MAX_REPEAT) hi = hi * 10 + (*p++ - '0');
+        }
+    }
+    if (*p != '}') return false;
+
+    if (lo > MAX_REPEAT || hi > MAX_REPEAT || (hi >= 0 && hi < lo)) {
+        ps->error = "invalid repetition bound";
+        return false;
+    }
+
+    ps->p = p + 1;
+    *min  = (int)lo;
+    *max  = (int)hi;
+    return true;
+}
+
+/**
+ * Parses an atom followed by any number of quantifiers.
+ */
+static int parse_repeat(Parser* ps) {
+    int node = parse_atom(ps);
+
+    while (node >= 0) {
+        int min, max;
+        char c = *ps->p;
+
+        if (c == '*') {
+            min = 0, max = -1;
+            ps->p++;
+        } else if (c == '+') {
+            min = 1, max = -1;
+            ps->p++;
+        } else if (c == '?') {
+            min = 0, max = 1;
+            ps->p++;
+        } else if (c == '{' && parse_bound(ps, &min, &max)) {
+            // bound consumed
+        } else {
+            break;
+        }
+
+        // Laziness does not change whether a match exists
+        if (*ps->p == '?') ps->p++;
+
+        int rep = new_ast(ps, AST_REPEAT);
+        if (rep < 0) return -1;
+        ps->re->ast[rep].left = node;
+        ps->re->ast[rep].min  = min;
+        ps->re->ast[rep].max  = max;
+        node                  = rep;
+    }
+
+    return ps->error ? -1 : node;
+}
+
+static int parse_concat(Parser* ps) {
+    int node = -1;
+
+    while (*ps->p != '\0' && *ps->p != '|' && *ps->p != ')') {
+        int next = parse_repeat(ps);
+        if (next < 0) return -1;
+        node = (node < 0) ? next : new_binary(ps, AST_CONCAT, node, next);
+        if (node < 0) return -1;
+    }
+
+    return node >= 0 ? node : new_ast(ps, AST_EMPTY);
+}
+
+static int parse_alternation(Parser* ps) {
+    int node = parse_concat(ps);
+
+    while (node >= 0 && *ps->p == '|') {
+        ps->p++;
+        int next = parse_concat(ps);
+        if (next < 0) return -1;
+        node = new_binary(ps, AST_ALT, node, next);
+    }
+    return node;
+}
+
+// =============================================================================
+// NFA CONSTRUCTION
+// =============================================================================
+
+static int new_nfa(Regex* re, NfaKind kind, int out, int out1, int cls) {
+    if (re->nfa_count >= MAX_NFA_STATES) return -1;
+
+    if (re->nfa_count == re->nfa_cap) {
+        int cap        = re->nfa_cap ? re->nfa_cap * 2 : 64;
+        NfaState* grow = realloc(re->nfa, sizeof(NfaState) * (size_t)cap);
+        if (!grow) return -1;
+        re->nfa     = grow;
+        re->nfa_cap = cap;
+    }
+
+    re->nfa[re->nfa_count] = (NfaState){kind, out, out1, cls};
+    return re->nfa_count++;
+}
+
+/**
+ * Compiles a node so that it continues to `next`. Building back to front lets
+ * repetitions simply compile their body several times.
+ * @return Entry state, or -1 on error.
+ */
+static int compile_node(Regex* re, int node, int next) {
+    const AstNode* n = &re->ast[node];
+
+    switch (n->kind) {
+        case AST_EMPTY:
+            return next;
+        case AST_CLASS:
+            return new_nfa(re, NFA_CLASS, next, -1, n->cls);
+        case AST_BEGIN:
+            return new_nfa(re, NFA_BEGIN, next, -1, -1);
+        case AST_END:
+            return new_nfa(re, NFA_END, next, -1, -1);
+        case AST_CONCAT: {
+            int right = compile_node(re, n->right, next);
+            return right < 0 ? -1 : compile_node(re, re->ast[node].left, right);
+        }
+        case AST_ALT: {
+            int left  = compile_node(re, n->left, next);
+            int right = left < 0 ? -1 : compile_node(re, re->ast[node].right, next);
+            return right < 0 ? -1 : new_nfa(re, NFA_SPLIT, left, right, -1);
+        }
+        case AST_REPEAT: {
+            int child = n->left;
+            int min   = n->min;
+            int max   = n->max;
+            int entry = next;
+
+            if (max < 0) {
+                // child* : loop through a split
+                int loop = new_nfa(re, NFA_SPLIT, -1, next, -1);
+                if (loop < 0) return -1;
+                int body = compile_node(re, child, loop);
+                if (body < 0) return -1;
+                re->nfa[loop].out = body;
+                entry             = loop;
+            } else {
+                // (child(child(...)?)?)? for the optional copies
+                for (int i = 0; i < max - min; i++) {
+                    int body = compile_node(re, child, entry);
+                    if (body < 0) return -1;
+                    entry = new_nfa(re, NFA_SPLIT, body, next, -1);
+                    if (entry < 0) return -1;
+                }
+            }
+
+            for (int i = 0; i < min; i++) {
+                entry = compile_node(re, child, entry);
+                if (entry < 0) return -1;
+            }
+            return entry;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Groups bytes that every class treats identically, shrinking DFA transition rows.
+ */
+static void build_byte_classes(Regex* re) {
+    int id = 0;
+    for (unsigned b = 0; b < 256; b++) {
+        if (b > 0) {
+            for (int s = 0; s < re->set_count; s++) {
+                if (set_has(&re->sets[s], b) != set_has(&re->sets[s], b - 1)) {
+                    id++;
+                    break;
+                }
+            }
+        }
+        re->byte_class[b] = (uint8_t)id;
+    }
+    re->num_byte_classes = id + 1;
+}
+
+// =============================================================================
+// LITERAL PREFILTER
+// =============================================================================
+
+/**
+ * Appends `b` to `a` within MAX_LITERAL-1 bytes. Keeps the head when `keep_head`,
+ * otherwise the tail. Returns false if anything was dropped.
+ */
+static bool literal_join(char* out, size_t* out_len, const char* a, size_t a_len, const char* b, size_t b_len,
+                         bool keep_head) {
+    char tmp[2 * MAX_LITERAL];
+    memcpy(tmp, a, a_len);
+    memcpy(tmp + a_len, b, b_len);
+
+    size_t total = a_len + b_len;
+    size_t limit = MAX_LITERAL - 1;
+    size_t len   = total < limit ? total : limit;
+
+    memcpy(out, keep_head ? tmp : tmp + (total - len), len);
+    *out_len = len;
+    return total <= limit;
+}
+
+static void literal_keep_best(LiteralInfo* info, const char* text, size_t len) {
+    if (len > info->best_len) {
+        memcpy(info->best, text, len);
+        info->best_len = len;
+    }
+}
+
+/**
+ * Computes the literals every match of a node must contain.
+ */
+static void analyze_literals(const Regex* re, int node, LiteralInfo* info) {
+    const AstNode* n = &re->ast[node];
+    memset(info, 0, sizeof(*info));
+
+    switch (n->kind) {
+        case AST_EMPTY:
+        case AST_BEGIN:
+        case AST_END:
+            info->exact = true;
+            return;
+
+        case AST_CLASS: {
+            const ByteSet* s = &re->sets[n->cls];
+            int bits         = set_count_bits(s);
+            int c            = -1;
+
+            for (unsigned b = 0; b < 256 && c < 0; b++) {
+                if (set_has(s, b)) c = (int)b;
+            }
+
+            // A single byte, or both cases of one letter under (?i)
+            bool literal = (bits == 1) || (re->nocase && bits == 2 && c >= 'A' && c <= 'Z' && set_has(s, (unsigned)c + 32));
+            if (!literal) return;
+
+            char ch          = (char)(re->nocase ? fold_ascii((unsigned char)c) : (unsigned char)c);
+            info->exact      = true;
+            info->exact_len  = info->prefix_len = info->suffix_len = info->best_len = 1;
+            info->exact_text[0] = info->prefix[0] = info->suffix[0] = info->best[0] = ch;
+            return;
+        }
+
+        case AST_CONCAT: {
+            LiteralInfo a, b;
+            analyze_literals(re, n->left, &a);
+            analyze_literals(re, n->right, &b);
+
+            if (a.exact && b.exact) {
+                info->exact = literal_join(info->exact_text, &info->exact_len, a.exact_text, a.exact_len,
+                                           b.exact_text, b.exact_len, true);
+            }
+
+            if (a.exact) {
+                literal_join(info->prefix, &info->prefix_len, a.exact_text, a.exact_len, b.prefix, b.prefix_len, true);
+            } else {
+                memcpy(info->prefix, a.prefix, a.prefix_len);
+                info->prefix_len = a.prefix_len;
+            }
+
+            if (b.exact) {
+                literal_join(info->suffix, &info->suffix_len, a.suffix, a.suffix_len, b.exact_text, b.exact_len, false);
+            } else {
+                memcpy(info->suffix, b.suffix, b.suffix_len);
+                info->suffix_len = b.suffix_len;
+            }
+
+            char joint[MAX_LITERAL];
+            size_t joint_len;
+            literal_join(joint, &joint_len, a.suffix, a.suffix_len, b.prefix, b.prefix_len, true);
+
+            literal_keep_best(info, a.best, a.best_len);
+            literal_keep_best(info, b.best, b.best_len);
+            literal_keep_best(info, joint, joint_len);
+            literal_keep_best(info, info->prefix, info->prefix_len);
+            literal_keep_best(info, info->suffix, info->suffix_len);
+            if (info->exact) literal_keep_best(info, info->exact_text, info->exact_len);
+            return;
+        }
+
+        case AST_REPEAT: {
+            if (n->min == 0) return;  // May match nothing at all
+
+            LiteralInfo child;
+            analyze_literals(re, n->left, &child);
+
+            memcpy(info->prefix, child.prefix, child.prefix_len);
+            info->prefix_len = child.prefix_len;
+            memcpy(info->suffix, child.suffix, child.suffix_len);
+            info->suffix_len = child.suffix_len;
+            memcpy(info->best, child.best, child.best_len);
+            info->best_len = child.best_len;
+
+            if (n->min == 1 && n->max == 1) *info = child;
+            return;
+        }
+
+        case AST_ALT:
+            return;
+    }
+}
+
+/**
+ * Finds `lit` in `text` using memchr on the first byte (folding case when asked).
+ */
+static bool literal_find(const char* text, size_t len, const char* lit, size_t lit_len, bool nocase) {
+    if (lit_len > len) return false;
+
+    const char* end = text + (len - lit_len);
+
+    if (!nocase) {
+        for (const char* p = text; p <= end; p++) {
+            p = memchr(p, lit[0], (size_t)(end - p) + 1);
+            if (p == NULL) return false;
+            if (memcmp(p, lit, lit_len) == 0) return true;
+        }
+        return false;
+    }
+
+    for (const char* p = text; p <= end; p++) {
+        if (fold_ascii((unsigned char)*p) != (unsigned char)lit[0]) continue;
+
+        size_t i = 1;
+        while (i < lit_len && fold_ascii((unsigned char)p[i]) == (unsigned char)lit[i]) i++;
+        if (i == lit_len) return true;
+    }
+    return false;
+}
+
+// =============================================================================
+// LAZY DFA
+// =============================================================================
+
+/**
+ * Adds the epsilon closure of NFA state `s` to the scratch set.
+ * Only CLASS, END and MATCH states are recorded; BEGIN is crossed only at position 0.
+ */
+static void add_closure(Regex* re, int s, bool at_begin) {
+    int top          = 0;
+    re->stack[top++] = s;
+
+    while (top > 0) {
+        int id = re->stack[--top];
+        if (id < 0 || re->mark[id] == re->mark_gen) continue;
+        re->mark[id] = re->mark_gen;
+
+        const NfaState* st = &re->nfa[id];
+        switch (st->kind) {
+            case NFA_SPLIT:
+                re->stack[top++] = st->out1;
+                re->stack[top++] = st->out;
+                break;
+            case NFA_BEGIN:
+                if (at_begin) re->stack[top++] = st->out;
+                break;
+            case NFA_CLASS:
+            case NFA_END:
+            case NFA_MATCH:
+                re->set_buf[re->set_len++] = id;
+                break;
+        }
+    }
+}
+
+/**
+ * Checks whether MATCH is reachable from the set when the input ends here.
+ * BEGIN is crossed only if the input is empty (`at_begin`), as in "$^".
+ */
+static bool reaches_match_at_end(Regex* re, const int* set, int count, bool at_begin) {
+    re->mark_gen++;
+    int top = 0;
+    for (int i = 0; i < count; i++) {
+        if (re->nfa[set[i]].kind == NFA_END) re->stack[top++] = re->nfa[set[i]].out;
+    }
+
+    while (top > 0) {
+        int id = re->stack[--top];
+        if (id < 0 || re->mark[id] == re->mark_gen) continue;
+        re->mark[id] = re->mark_gen;
+
+        const NfaState* st = &re->nfa[id];
+        if (st->kind == NFA_MATCH) return true;
+        if (st->kind == NFA_SPLIT) {
+            re->stack[top++] = st->out1;
+            re->stack[top++] = st->out;
+        } else if (st->kind == NFA_END || (st->kind == NFA_BEGIN && at_begin)) {
+            re->stack[top++] = st->out;
+        }
+    }
+    return false;
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t hash_set(const int* set, int count) {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < count; i++) {
+        h ^= (uint64_t)(uint32_t)set[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * Drops every DFA state; they are rebuilt on demand. Keeps memory bounded.
+ */
+static void dfa_flush(Regex* re) {
+    for (int i = 0; i < re->dfa_count; i++) {
+        free(re->dfa[i].states);
+        free(re->dfa[i].next);
+    }
+    re->dfa_count = 0;
+    re->dfa_start = -1;
+    for (size_t i = 0; i < re->table_cap; i++) re->table[i] = -1;
+}
+
+/**
+ * Returns the DFA state for the scratch set, creating it if needed.
+ * @return State index, or -1 on allocation failure.
+ */
+static int dfa_intern(Regex* re) {
+    int count = re->set_len;
+    qsort(re->set_buf, (size_t)count, sizeof(int), compare_ints);
+
+    uint64_t h  = hash_set(re->set_buf, count);
+    size_t mask = re->table_cap - 1;
+    size_t slot = (size_t)h & mask;
+
+    while (re->table[slot] >= 0) {
+        const DfaState* d = &re->dfa[re->table[slot]];
+        if (d->count == count && memcmp(d->states, re->set_buf, sizeof(int) * (size_t)count) == 0) {
+            return re->table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (re->dfa_count >= MAX_DFA_STATES) {
+        dfa_flush(re);
+        return dfa_intern(re);
+    }
+
+    if (re->dfa_count == re->dfa_cap) {
+        int cap        = re->dfa_cap ? re->dfa_cap * 2 : 64;
+        DfaState* grow = realloc(re->dfa, sizeof(DfaState) * (size_t)cap);
+        if (!grow) return -1;
+        re->dfa     = grow;
+        re->dfa_cap = cap;
+    }
+
+    DfaState* d = &re->dfa[re->dfa_count];
+    d->count    = count;
+    d->states   = malloc(sizeof(int) * (size_t)(count > 0 ? count : 1));
+    d->next     = malloc(sizeof(int32_t) * (size_t)re->num_byte_classes);
+    if (!d->states || !d->next) {
+        free(d->states);
+        free(d->next);
+        return -1;
+    }
+
+    memcpy(d->states, re->set_buf, sizeof(int) * (size_t)count);
+    for (int i = 0; i < re->num_byte_classes; i++) d->next[i] = -1;
+
+    d->match = false;
+    for (int i = 0; i < count; i++) {
+        if (re->nfa[d->states[i]].kind == NFA_MATCH) d->match = true;
+    }
+    d->match_at_end = d->match || reaches_match_at_end(re, d->states, count, false);
+
+    re->table[slot] = re->dfa_count;
+    return re->dfa_count++;
+}
+
+/**
+ * Builds the DFA state for position 0.
+ */
+static int dfa_start_state(Regex* re) {
+    if (re->dfa_start < 0) {
+        re->mark_gen++;
+        re->set_len = 0;
+        add_closure(re, re->nfa_start, true);
+        re->dfa_start = dfa_intern(re);
+
+        const DfaState* d = re->dfa_start >= 0 ? &re->dfa[re->dfa_start] : NULL;
+        re->empty_match   = d != NULL && (d->match || reaches_match_at_end(re, d->states, d->count, true));
+    }
+    return re->dfa_start;
+}
+
+/**
+ * Computes the transition of state `from` on `byte` and records it.
+ */
+static int dfa_step(Regex* re, int from, unsigned char byte) {
+    re->mark_gen++;
+    re->set_len = 0;
+
+    const DfaState* d = &re->dfa[from];
+    for (int i = 0; i < d->count; i++) {
+        const NfaState* st = &re->nfa[d->states[i]];
+        if (st->kind == NFA_CLASS && set_has(&re->sets[st->cls], byte)) {
+            add_closure(re, st->out, false);
+        }
+    }
+
+    // Unanchored search: a match may also start at the next position
+    add_closure(re, re->nfa_start, false);
+
+    int before = re->dfa_count;
+    int to     = dfa_intern(re);
+
+    // Only link the edge if the cache was not flushed underneath us
+    if (to >= 0 && re->dfa_count >= before && from < re->dfa_count) {
+        re->dfa[from].next[re->byte_class[byte]] = to;
+    }
+    return to;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+Regex* regex_compile(const char* pattern) {
+    if (pattern == NULL) return NULL;
+
+    Regex* re = calloc(1, sizeof(Regex));
+    if (!re) {
+        fprintf(stderr, "Error: Memory allocation failed for regex\n");
+        return NULL;
+    }
+    re->dfa_start = -1;
+
+    Parser ps = {.re = re, .p = pattern, .error = NULL};
+    if (strncmp(ps.p, "(?i)", 4) == 0) {
+        re->nocase = true;
+        ps.p += 4;
+    }
+
+    int root = parse_alternation(&ps);
+    if (root >= 0 && *ps.p == ')') ps.error = "unmatched ')'";
+    if (root < 0 || ps.error) {
+        fprintf(stderr, "Error: Invalid regex '%s': %s\n", pattern, ps.error ? ps.error : "parse error");
+        regex_free(re);
+        return NULL;
+    }
+
+    int match     = new_nfa(re, NFA_MATCH, -1, -1, -1);
+    re->nfa_start = match < 0 ? -1 : compile_node(re, root, match);
+    if (re->nfa_start < 0) {
+        fprintf(stderr, "Error: Regex '%s' is too large\n", pattern);
+        regex_free(re);
+        return NULL;
+    }
+
+    LiteralInfo info;
+    analyze_literals(re, root, &info);
+    memcpy(re->literal, info.best, info.best_len);
+    re->literal_len  = info.best_len;
+    re->literal_only = info.exact && !re->has_anchors && info.exact_len == info.best_len;
+
+    build_byte_classes(re);
+
+    re->table_cap = 1;
+    while (re->table_cap < (size_t)MAX_DFA_STATES * 2) re->table_cap <<= 1;
+
+    re->table   = malloc(sizeof(int) * re->table_cap);
+    re->stack   = malloc(sizeof(int) * ((size_t)re->nfa_count * 3 + 1));
+    re->mark    = calloc((size_t)re->nfa_count, sizeof(uint32_t));
+    re->set_buf = malloc(sizeof(int) * (size_t)re->nfa_count);
+    if (!re->table || !re->stack || !re->mark || !re->set_buf) {
+        fprintf(stderr, "Error: Memory allocation failed for regex\n");
+        regex_free(re);
+        return NULL;
+    }
+    for (size_t i = 0; i < re->table_cap; i++) re->table[i] = -1;
+
+    return re;
+}
+
+bool regex_search(Regex* re, const char* text, size_t len) {
+    if (re->literal_len > 0 && !literal_find(text, len, re->literal, re->literal_len, re->nocase)) {
+        return false;
+    }
+    if (re->literal_only) {
+        return true;
+    }
+
+    int s = dfa_start_state(re);
+    if (s < 0) return false;
+
+    for (size_t i = 0; i < len; i++) {
+        const DfaState* d = &re->dfa[s];
+        if (d->match) return true;
+        if (d->count == 0) return false;  // Dead state
+
+        unsigned char byte = (unsigned char)text[i];
+        int next           = d->next[re->byte_class[byte]];
+        if (next < 0) {
+            next = dfa_step(re, s, byte);
+            if (next < 0) return false;
+        }
+        s = next;
+    }
+
+    return len == 0 ? re->empty_match : re->dfa[s].match_at_end;
+}
+
+void regex_free(Regex* re) {
+    if (!re) return;
+
+    for (int i = 0; i < re->dfa_count; i++) {
+        free(re->dfa[i].states);
+        free(re->dfa[i].next);
+    }
+    free(re->dfa);
+    free(re->table);
+    free(re->stack);
+    free(re->mark);
+    free(re->set_buf);
+    free(re->nfa);
+    free(re->sets);
+    free(re->ast);
+    free(re);
+}
@@ -0,0 +1,212 @@
+#include "../include/result-cache.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "../include/hash-set.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#define dup    _dup
+#define dup2   _dup2
+#define close  _close
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+/** Entry magic and layout version. */
+#define RESULT_MAGIC "CSVQRES2"
+
+/** Fixed-size entry header, followed by the query text and then the output bytes. */
+typedef struct {
+    char magic[8];
+    FileFingerprint file;
+    uint64_t query_len;
+} ResultHeader;
+
+/**
+ * Creates the cache directory unless it already exists.
+ */
+bool result_cache_make_dir(const char* dir) {
+#ifdef _WIN32
+    int rc = _mkdir(dir);
+#else
+    int rc = mkdir(dir, 0755);
+#endif
+    return rc == 0 || errno == EEXIST;
+}
+
+/**
+ * Builds "<dir>/<hash of file state and query><suffix>" in a malloc'd buffer.
+ */
+static char* entry_path(const char* dir, const FileFingerprint* fp, const char* query, const char* suffix) {
+    uint64_t h = HASH_SEED;
+    h          = hash_bytes(h, fp, sizeof(*fp));
+    h          = hash_bytes(h, query, strlen(query));
+    return cache_entry_path(dir, h, RESULT_CACHE_SUFFIX, suffix);
+}
+
+/**
+ * Streams a cached result to stdout if the cache holds one for this file state and query.
+ */
+bool result_cache_replay(const char* dir, const FileFingerprint* fp, const char* query) {
+    char* path = entry_path(dir, fp, query, "");
+    if (path == NULL) {
+        return false;
+    }
+
+    FILE* f = fopen(path, "rb");
+    free(path);
+    if (f == NULL) {
+        return false;
+    }
+
+    ResultHeader hdr;
+    size_t query_len = strlen(query);
+
+    bool match = fread(&hdr, sizeof(hdr), 1, f) == 1 && memcmp(hdr.magic, RESULT_MAGIC, 8) == 0 &&
+                 file_fingerprint_equal(&hdr.file, fp) && hdr.query_len == query_len;
+
+    char buf[1 << 16];
+    for (size_t done = 0; match && done < query_len;) {
+        size_t want = query_len - done < sizeof(buf) ? query_len - done : sizeof(buf);
+        match       = fread(buf, 1, want, f) == want && memcmp(buf, query + done, want) == 0;
+        done += want;
+    }
+
+    if (match) {
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            fwrite(buf, 1, n, stdout);
+        }
+    }
+
+    fclose(f);
+    return match;
+}
+
+/**
+ * Starts capturing stdout into a new cache entry.
+ */
+bool result_cache_begin(ResultCapture* cap, const char* dir, const FileFingerprint* fp, const char* query) {
+    memset(cap, 0, sizeof(*cap));
+    cap->saved_fd  = -1;
+    cap->saved_err = -1;
+
+    if (!result_cache_make_dir(dir)) {
+        fprintf(stderr, "Warning: Cannot create cache directory '%s'; result not cached\n", dir);
+        return false;
+    }
+
+    cap->path     = entry_path(dir, fp, query, "");
+    cap->tmp_path = entry_path(dir, fp, query, ".tmp");
+    cap->file     = cap->tmp_path != NULL ? fopen(cap->tmp_path, "w+b") : NULL;
+    if (cap->path == NULL || cap->file == NULL) {
+        fprintf(stderr, "Warning: Cannot write to cache directory '%s'; result not cached\n", dir);
+        result_cache_end(cap, false);
+        return false;
+    }
+
+    ResultHeader hdr = {0};
+    memcpy(hdr.magic, RESULT_MAGIC, 8);
+    hdr.file      = *fp;
+    hdr.query_len = strlen(query);
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, cap->file) == 1 &&
+              fwrite(query, 1, hdr.query_len, cap->file) == hdr.query_len && fflush(cap->file) == 0;
+    cap->data_at = ftell(cap->file);
+
+    // Point the stdout descriptor at the entry, so output from any writer is captured
+    fflush(stdout);
+    if (ok && cap->data_at >= 0) {
+        cap->saved_fd = dup(fileno(stdout));
+    }
+    if (cap->saved_fd < 0 || dup2(fileno(cap->file), fileno(stdout)) < 0) {
+        fprintf(stderr, "Warning: Cannot capture output; result not cached\n");
+        result_cache_end(cap, false);
+        return false;
+    }
+
+    // Stderr is captured too: an entry is only written for a run that reported nothing there
+    fflush(stderr);
+    cap->errors = tmpfile();
+    if (cap->errors != NULL) {
+        cap->saved_err = dup(fileno(stderr));
+    }
+    if (cap->saved_err < 0 || dup2(fileno(cap->errors), fileno(stderr)) < 0) {
+        fprintf(stderr, "Warning: Cannot capture errors; result not cached\n");
+        result_cache_end(cap, false);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Restores stderr and prints what was written to it meanwhile.
+ * @return true if nothing was written.
+ */
+static bool release_errors(ResultCapture* cap) {
+    bool quiet = true;
+    if (cap->saved_err >= 0) {
+        fflush(stderr);
+        dup2(cap->saved_err, fileno(stderr));
+        close(cap->saved_err);
+        cap->saved_err = -1;
+    }
+
+    if (cap->errors != NULL) {
+        if (fseek(cap->errors, 0, SEEK_SET) == 0) {
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), cap->errors)) > 0) {
+                fwrite(buf, 1, n, stderr);
+                quiet = false;
+            }
+        }
+        fclose(cap->errors);
+        cap->errors = NULL;
+    }
+    return quiet;
+}
+
+/**
+ * Restores stdout and stderr, prints the captured output to them and commits or drops the entry.
+ */
+void result_cache_end(ResultCapture* cap, bool success) {
+    bool quiet    = release_errors(cap);
+    bool captured = cap->saved_fd >= 0;
+
+    if (captured) {
+        fflush(stdout);
+        dup2(cap->saved_fd, fileno(stdout));
+        close(cap->saved_fd);
+        cap->saved_fd = -1;
+    }
+
+    bool ok = captured && success && quiet;
+    if (cap->file != NULL) {
+        // The captured bytes went through the descriptor, so the stream position is stale
+        if (captured && fseek(cap->file, cap->data_at, SEEK_SET) == 0) {
+            char buf[1 << 16];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), cap->file)) > 0) {
+                fwrite(buf, 1, n, stdout);
+            }
+            ok = ok && !ferror(cap->file);
+        }
+        ok = fclose(cap->file) == 0 && ok;
+    }
+
+    if (cap->tmp_path != NULL) {
+        replace_file(cap->tmp_path, cap->path, ok);
+    }
+
+    free(cap->path);
+    free(cap->tmp_path);
+    memset(cap, 0, sizeof(*cap));
+    cap->saved_fd  = -1;
+    cap->saved_err = -1;
+}
@@ -0,0 +1,330 @@
+#include "../include/sidecar-index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "../include/hash-set.h"
+
+/** File magic and layout version; bump the version when the layout changes. */
+#define SIDECAR_MAGIC   "CSVQIDX"
+#define SIDECAR_VERSION 3
+
+/** Bytes hashed at each end of the source file for the fingerprint. */
+#define FINGERPRINT_SAMPLE 4096
+
+/** Kinds of per-column sections stored in the index. */
+typedef enum {
+    SECTION_ZONES = 1,  // Zone array, one per ZONE_ROWS block
+    SECTION_BLOOM = 2,  // Bloom filters, BLOOM_BLOCK_WORDS words per ZONE_ROWS block
+    SECTION_TIMES = 3,  // TimeRange array, one per ZONE_ROWS block
+    SECTION_ORDER = 4,  // OrderSection: whether the column is sorted
+} SectionKind;
+
+/** Fixed-size file header. */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_rows;  // ZONE_ROWS at build time
+    FileFingerprint file;
+    uint64_t row_count;
+    uint64_t col_count;
+    uint8_t delimiter;
+    uint8_t comment;
+    uint8_t has_header;
+    uint8_t reserved[5];
+} SidecarHeader;
+
+/** Header preceding each section payload. */
+typedef struct {
+    uint32_t kind;    // SectionKind
+    uint32_t column;  // Column the section describes
+    uint64_t bytes;   // Payload size
+} SectionHeader;
+
+/** Payload of a SECTION_ORDER section. */
+typedef struct {
+    uint8_t cells;  // column_cache_order() bits
+    uint8_t times;  // column_cache_time_order() bits, 0 if not known
+    uint8_t reserved[6];
+} OrderSection;
+
+/**
+ * Computes the fingerprint of a file.
+ */
+bool file_fingerprint(const char* path, FileFingerprint* fp) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+
+    unsigned char buf[FINGERPRINT_SAMPLE];
+    uint64_t h = HASH_SEED;
+
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    h        = hash_bytes(h, buf, n);
+
+    if ((uint64_t)st.st_size > FINGERPRINT_SAMPLE && fseek(f, -(long)FINGERPRINT_SAMPLE, SEEK_END) == 0) {
+        n = fread(buf, 1, sizeof(buf), f);
+        h = hash_bytes(h, buf, n);
+    }
+    fclose(f);
+
+    // Whole seconds miss a same-size edit made within the second of the previous one
+#if defined(_WIN32)
+    int64_t nsec = 0;
+#elif defined(__APPLE__)
+    int64_t nsec = st.st_mtimespec.tv_nsec;
+#else
+    int64_t nsec = st.st_mtim.tv_nsec;
+#endif
+
+    fp->size        = (uint64_t)st.st_size;
+    fp->mtime       = (int64_t)st.st_mtime * 1000000000 + nsec;
+    fp->inode       = (uint64_t)st.st_ino;
+    fp->sample_hash = h;
+    return true;
+}
+
+/**
+ * Compares two fingerprints field by field.
+ */
+bool file_fingerprint_equal(const FileFingerprint* a, const FileFingerprint* b) {
+    return a->size == b->size && a->mtime == b->mtime && a->inode == b->inode && a->sample_hash == b->sample_hash;
+}
+
+/**
+ * Builds "<dir>/<hash as 16 hex digits><ext><suffix>" in a malloc'd buffer.
+ */
+char* cache_entry_path(const char* dir, uint64_t hash, const char* ext, const char* suffix) {
+    size_t len = strlen(dir) + 1 + 16 + strlen(ext) + strlen(suffix) + 1;
+    char* path = malloc(len);
+    if (path != NULL) {
+        snprintf(path, len, "%s/%016llx%s%s", dir, (unsigned long long)hash, ext, suffix);
+    }
+    return path;
+}
+
+/**
+ * Renames a completed temporary file over `path`, or removes it.
+ */
+bool replace_file(const char* tmp_path, const char* path, bool ok) {
+#ifdef _WIN32
+    if (ok) {
+        remove(path);  // rename() does not replace an existing file on Windows
+    }
+#endif
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Fills a sidecar key for the file and parse settings behind `cache`.
+ */
+bool sidecar_key_init(SidecarKey* key, const char* csv_path, const ColumnCache* cache, char delimiter, char comment,
+                      bool has_header) {
+    memset(key, 0, sizeof(*key));
+    if (!file_fingerprint(csv_path, &key->file)) {
+        return false;
+    }
+
+    key->row_count  = cache->row_count;
+    key->col_count  = cache->col_count;
+    key->delimiter  = (uint8_t)delimiter;
+    key->comment    = (uint8_t)comment;
+    key->has_header = has_header ? 1 : 0;
+    return true;
+}
+
+/**
+ * Builds "<csv_path><suffix>" in a malloc'd buffer.
+ */
+static char* sidecar_path(const char* csv_path, const char* suffix) {
+    size_t len = strlen(csv_path);
+    size_t add = strlen(suffix);
+    char* path = malloc(len + add + 1);
+    if (path != NULL) {
+        memcpy(path, csv_path, len);
+        memcpy(path + len, suffix, add + 1);
+    }
+    return path;
+}
+
+/**
+ * Checks whether a stored header was built from the same file and settings.
+ */
+static bool header_matches(const SidecarHeader* hdr, const SidecarKey* key) {
+    return memcmp(hdr->magic, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC)) == 0 && hdr->version == SIDECAR_VERSION &&
+           hdr->block_rows == ZONE_ROWS && file_fingerprint_equal(&hdr->file, &key->file) && hdr->row_count == key->row_count &&
+           hdr->col_count == key->col_count && hdr->delimiter == key->delimiter && hdr->comment == key->comment &&
+           hdr->has_header == key->has_header;
+}
+
+/**
+ * Loads the sidecar index of `csv_path` and installs its data into the cache.
+ */
+bool sidecar_load(const char* csv_path, const SidecarKey* key, ColumnCache* cache) {
+    char* path = sidecar_path(csv_path, SIDECAR_SUFFIX);
+    if (path == NULL) {
+        return false;
+    }
+
+    FILE* f = fopen(path, "rb");
+    free(path);
+    if (f == NULL) {
+        return false;
+    }
+
+    SidecarHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 || !header_matches(&hdr, key)) {
+        fclose(f);
+        return false;
+    }
+
+    size_t blocks      = column_cache_block_count(cache);
+    size_t zone_bytes  = sizeof(Zone) * blocks;
+    size_t time_bytes  = sizeof(TimeRange) * blocks;
+    size_t bloom_bytes = sizeof(uint64_t) * BLOOM_BLOCK_WORDS * blocks;
+
+    // One buffer serves every section kind
+    size_t max_bytes = bloom_bytes > zone_bytes ? bloom_bytes : zone_bytes;
+    void* payload    = malloc(max_bytes > sizeof(OrderSection) ? max_bytes : sizeof(OrderSection));
+    if (payload == NULL) {
+        fclose(f);
+        return false;
+    }
+
+    bool ok = true;
+    SectionHeader sec;
+    while (ok && fread(&sec, sizeof(sec), 1, f) == 1) {
+        bool sized = (sec.kind == SECTION_ZONES && sec.bytes == zone_bytes) ||
+                     (sec.kind == SECTION_TIMES && sec.bytes == time_bytes) ||
+                     (sec.kind == SECTION_BLOOM && sec.bytes == bloom_bytes) ||
+                     (sec.kind == SECTION_ORDER && sec.bytes == sizeof(OrderSection));
+        bool known = sec.column < cache->col_count && sized;
+        if (!known) {
+            ok = fseek(f, (long)sec.bytes, SEEK_CUR) == 0;  // Unknown section kinds are skipped
+            continue;
+        }
+
+        if (fread(payload, 1, sec.bytes, f) != sec.bytes) {
+            ok = false;
+        } else if (sec.kind == SECTION_ZONES) {
+            column_cache_set_zones(cache, sec.column, payload);
+        } else if (sec.kind == SECTION_TIMES) {
+            column_cache_set_time_ranges(cache, sec.column, payload);
+        } else if (sec.kind == SECTION_ORDER) {
+            const OrderSection* order = payload;
+            column_cache_set_order(cache, sec.column, order->cells, order->times);
+        } else {
+            column_cache_set_blooms(cache, sec.column, payload);
+        }
+    }
+
+    free(payload);
+    fclose(f);
+    return ok;
+}
+
+/**
+ * Writes one section header followed by its payload.
+ */
+static bool write_section(FILE* f, SectionKind kind, size_t column, const void* data, size_t bytes) {
+    SectionHeader sec = {.kind = (uint32_t)kind, .column = (uint32_t)column, .bytes = bytes};
+    return fwrite(&sec, sizeof(sec), 1, f) == 1 && (bytes == 0 || fwrite(data, 1, bytes, f) == bytes);
+}
+
+/**
+ * Parses every column, computes the index data and writes the sidecar next to `csv_path`.
+ * The file is written under a temporary name first and moved into place by replace_file().
+ */
+bool sidecar_build(const char* csv_path, const SidecarKey* key, ColumnCache* cache, const bool* bloom_columns) {
+    char* path = sidecar_path(csv_path, SIDECAR_SUFFIX);
+    char* tmp  = sidecar_path(csv_path, SIDECAR_SUFFIX ".tmp");
+    if (path == NULL || tmp == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for index path\n");
+        free(path);
+        free(tmp);
+        return false;
+    }
+
+    FILE* f = fopen(tmp, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "Error: Cannot write index file '%s'\n", tmp);
+        free(path);
+        free(tmp);
+        return false;
+    }
+
+    SidecarHeader hdr = {0};
+    memcpy(hdr.magic, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+    hdr.version    = SIDECAR_VERSION;
+    hdr.block_rows = ZONE_ROWS;
+    hdr.file       = key->file;
+    hdr.row_count  = key->row_count;
+    hdr.col_count  = key->col_count;
+    hdr.delimiter  = key->delimiter;
+    hdr.comment    = key->comment;
+    hdr.has_header = key->has_header;
+
+    bool ok            = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    size_t zone_bytes  = sizeof(Zone) * column_cache_block_count(cache);
+    size_t time_bytes  = sizeof(TimeRange) * column_cache_block_count(cache);
+    size_t bloom_bytes = sizeof(uint64_t) * BLOOM_BLOCK_WORDS * column_cache_block_count(cache);
+
+    for (size_t c = 0; ok && c < cache->col_count; c++) {
+        const ColumnVector* vec = column_cache_get(cache, c);
+        if (vec == NULL) {
+            ok = false;
+            break;
+        }
+
+        // Zone maps only help columns that hold numbers
+        const Zone* zones = vec->numeric_count > 0 ? column_cache_zones(cache, c) : NULL;
+        if (zones != NULL) {
+            ok = write_section(f, SECTION_ZONES, c, zones, zone_bytes);
+        }
+
+        // Text columns are checked for timestamps; ranges are only stored if some cell parsed
+        const TimeVector* tv    = vec->numeric_count == 0 ? column_cache_get_times(cache, c) : NULL;
+        const TimeRange* ranges = (tv != NULL && tv->valid_count > 0) ? column_cache_time_ranges(cache, c) : NULL;
+        if (ok && ranges != NULL) {
+            ok = write_section(f, SECTION_TIMES, c, ranges, time_bytes);
+        }
+
+        // Sorted columns skip --sort and let range conditions binary-search for their rows
+        OrderSection order = {.cells = column_cache_order(cache, c),
+                              .times = ranges != NULL ? column_cache_time_order(cache, c) : 0};
+        if (ok) {
+            ok = write_section(f, SECTION_ORDER, c, &order, sizeof(order));
+        }
+
+        if (ok && bloom_columns != NULL && bloom_columns[c]) {
+            if (vec->blooms == NULL && !column_cache_build_blooms(cache, c)) {
+                ok = false;
+                break;
+            }
+            ok = write_section(f, SECTION_BLOOM, c, vec->blooms, bloom_bytes);
+        }
+    }
+
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+
+    ok = replace_file(tmp, path, ok);
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write index file '%s'\n", path);
+    }
+
+    free(path);
+    free(tmp);
+    return ok;
+}
@@ -0,0 +1,633 @@
+#include "../include/sort-keys.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "../include/ascii-fold.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/** Buckets smaller than this are finished with an insertion sort. */
+#define INSERTION_MAX 32
+
+/** Nested bucket splits before a text bucket is finished by a merge sort, bounding stack use. */
+#define MSD_MAX_LEVELS 32
+
+/** Upper bound on sort threads. */
+#define MAX_SORT_THREADS 64
+
+/** Upper bound on tasks per merge round: a thread share per merge, rounded up. */
+#define MAX_SORT_TASKS (MAX_SORT_THREADS * 2)
+
+/** Fewest keys per thread; smaller sorts run on the calling thread. */
+#define PARALLEL_MIN_KEYS (1 << 16)
+
+/** A heap selects the first `keep` keys instead of a full sort when keep <= n / TOP_K_RATIO. */
+#define TOP_K_RATIO 16
+
+/**
+ * Packs the case-folded text prefix into a big-endian integer.
+ */
+uint64_t sort_key_prefix(const char* text) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < SORT_KEY_PREFIX && text[i] != '\0'; i++) {
+        key |= (uint64_t)ascii_fold((unsigned char)text[i]) << (8 * (SORT_KEY_PREFIX - 1 - i));
+    }
+    return key;
+}
+
+/** Composite key tags, in ascending order. */
+#define TAG_BLANK  0x01
+#define TAG_NUMBER 0x02
+#define TAG_TEXT   0x03
+
+/**
+ * Inverts the bytes of a descending column, so memcmp() order is reversed.
+ */
+static size_t invert_if(unsigned char* out, size_t len, bool desc) {
+    for (size_t i = 0; desc && i < len; i++) {
+        out[i] = (unsigned char)~out[i];
+    }
+    return len;
+}
+
+/**
+ * Encodes a blank cell: the tag alone.
+ */
+size_t sort_key_encode_blank(unsigned char* out, bool desc) {
+    out[0] = TAG_BLANK;
+    return invert_if(out, 1, desc);
+}
+
+/**
+ * Encodes a number: the tag, then sort_key_number() big-endian.
+ */
+size_t sort_key_encode_number(unsigned char* out, double value, bool desc) {
+    uint64_t key = sort_key_number(value);
+    out[0]       = TAG_NUMBER;
+    for (unsigned i = 0; i < 8; i++) {
+        out[1 + i] = (unsigned char)(key >> (8 * (7 - i)));
+    }
+    return invert_if(out, SORT_KEY_NUMBER_BYTES, desc);
+}
+
+/**
+ * Encodes a text: the tag, the folded bytes, then a zero byte. Text bytes are never zero,
+ * so a shorter text sorts before every longer text it is a prefix of.
+ */
+size_t sort_key_encode_text(unsigned char* out, const char* text, bool desc) {
+    size_t len = 0;
+    out[len++] = TAG_TEXT;
+    for (; *text != '\0'; text++) {
+        out[len++] = ascii_fold((unsigned char)*text);
+    }
+    out[len++] = 0;
+    return invert_if(out, len, desc);
+}
+
+/**
+ * LSD radix sort of number keys, using `tmp` (n keys) as the second buffer.
+ */
+static void lsd_sort_numbers(SortKey* keys, SortKey* tmp, size_t n, bool desc) {
+    // One histogram per byte, all filled in a single pass
+    size_t counts[8][256] = {{0}};
+    for (size_t i = 0; i < n; i++) {
+        uint64_t k = keys[i].key;
+        for (unsigned b = 0; b < 8; b++) {
+            counts[b][(k >> (8 * b)) & 0xff]++;
+        }
+    }
+
+    SortKey* src = keys;
+    SortKey* dst = tmp;
+    for (unsigned b = 0; n > 0 && b < 8; b++) {
+        size_t* count = counts[b];
+        if (count[keys[0].key >> (8 * b) & 0xff] == n) {
+            continue;  // Every key has the same byte here
+        }
+
+        // Bucket offsets, in reverse bucket order for a descending sort
+        size_t offset = 0;
+        for (unsigned d = 0; d < 256; d++) {
+            unsigned bucket = desc ? 255 - d : d;
+            size_t c        = count[bucket];
+            count[bucket]   = offset;
+            offset += c;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            dst[count[(src[i].key >> (8 * b)) & 0xff]++] = src[i];
+        }
+
+        SortKey* swap = src;
+        src           = dst;
+        dst           = swap;
+    }
+
+    if (src != keys) {
+        memcpy(keys, src, sizeof(SortKey) * n);
+    }
+}
+
+/**
+ * Orders two number keys. Equal keys are left to the caller, which keeps them in order.
+ */
+static int compare_number_keys(const SortKey* a, const SortKey* b, bool desc) {
+    int result = (a->key > b->key) - (a->key < b->key);
+    return desc ? -result : result;
+}
+
+/**
+ * Orders two text keys whose inline prefix holds the text from byte `depth` on: prefix,
+ * then the rest of the text, then row.
+ */
+static int compare_text_at(const SortKey* a, const SortKey* b, size_t depth, bool desc) {
+    int result = (a->key > b->key) - (a->key < b->key);
+
+    // Equal prefixes only hide more text when they are full
+    if (result == 0 && (a->key & 0xff) != 0) {
+        result = strcasecmp(a->text + depth + SORT_KEY_PREFIX, b->text + depth + SORT_KEY_PREFIX);
+    }
+
+    if (result != 0) {
+        return desc ? -result : result;
+    }
+    return (a->row > b->row) - (a->row < b->row);
+}
+
+/**
+ * Orders two text keys: prefix, then the rest of the text, then row.
+ */
+static int compare_text_keys(const SortKey* a, const SortKey* b, bool desc) { return compare_text_at(a, b, 0, desc); }
+
+/**
+ * Stable insertion sort for small buckets.
+ */
+static void insertion_sort_text(SortKey* keys, size_t n, size_t depth, bool desc) {
+    for (size_t i = 1; i < n; i++) {
+        SortKey k = keys[i];
+        size_t j  = i;
+        while (j > 0 && compare_text_at(&keys[j - 1], &k, depth, desc) > 0) {
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        keys[j] = k;
+    }
+}
+
+/**
+ * Orders two composite keys: one memcmp() of their common length, then row. The direction
+ * is encoded in the bytes.
+ */
+static int compare_composite_keys(const SortKey* a, const SortKey* b, bool desc) {
+    (void)desc;
+    int result = memcmp(a->text, b->text, a->key < b->key ? a->key : b->key);
+    if (result != 0) {
+        return result;
+    }
+    return (a->row > b->row) - (a->row < b->row);
+}
+
+/** qsort() adapter for composite keys. */
+static int compare_composite(const void* a, const void* b) { return compare_composite_keys(a, b, false); }
+
+/**
+ * Sorts a run of composite keys.
+ */
+static void sort_composite_run(SortKey* keys, SortKey* tmp, size_t n, bool desc) {
+    (void)tmp;
+    (void)desc;
+    qsort(keys, n, sizeof(SortKey), compare_composite);
+}
+
+/**
+ * Stable merge sort of text keys whose prefixes hold the text from byte `depth` on, using
+ * `tmp` (n keys) as the merge buffer. Finishes buckets too deep to keep bucketing.
+ */
+static void merge_sort_text(SortKey* keys, SortKey* tmp, size_t n, size_t depth, bool desc) {
+    if (n < INSERTION_MAX) {
+        insertion_sort_text(keys, n, depth, desc);
+        return;
+    }
+
+    size_t half = n / 2;
+    merge_sort_text(keys, tmp, half, depth, desc);
+    merge_sort_text(keys + half, tmp, n - half, depth, desc);
+
+    size_t i = 0, j = half, out = 0;
+    while (i < half && j < n) {
+        tmp[out++] = compare_text_at(&keys[j], &keys[i], depth, desc) < 0 ? keys[j++] : keys[i++];
+    }
+    while (i < half) {
+        tmp[out++] = keys[i++];
+    }
+    memcpy(keys, tmp, sizeof(SortKey) * out);  // The rest of the right half is already in place
+}
+
+/**
+ * Sorts keys that share their first `byte` prefix bytes, bucketing on the next byte they
+ * don't all share. The prefixes hold the text from byte `depth` on. Shared bytes and shared
+ * prefixes are skipped in a loop, so only real bucket splits nest, and past
+ * MSD_MAX_LEVELS of them the bucket is finished by merge_sort_text().
+ */
+static void msd_sort_text(SortKey* keys, SortKey* tmp, size_t n, size_t depth, unsigned byte, unsigned level,
+                          bool desc) {
+    if (n < INSERTION_MAX) {
+        insertion_sort_text(keys, n, depth, desc);
+        return;
+    }
+
+    uint64_t shared = keys[0].key;
+    size_t entry    = depth;
+    unsigned shift  = 0;
+    bool tied       = false;
+    size_t count[256];
+
+    for (;;) {
+        if (byte == SORT_KEY_PREFIX) {
+            // The whole prefix ties; a shorter text has ended, so the keys are already equal
+            if ((keys[0].key & 0xff) == 0) {
+                tied = true;
+                break;
+            }
+
+            // Load the next prefix of every text and keep bucketing, so a long common head
+            // (URLs, paths) costs one read per key instead of strcasecmp() per comparison
+            depth += SORT_KEY_PREFIX;
+            byte = 0;
+            for (size_t i = 0; i < n; i++) {
+                keys[i].key = sort_key_prefix(keys[i].text + depth);
+            }
+        }
+
+        shift = 8 * (SORT_KEY_PREFIX - 1 - byte);
+        memset(count, 0, sizeof(count));
+        for (size_t i = 0; i < n; i++) {
+            count[(keys[i].key >> shift) & 0xff]++;
+        }
+
+        // A byte every key shares needs no scatter
+        if (count[(keys[0].key >> shift) & 0xff] != n) {
+            break;
+        }
+        byte++;
+    }
+
+    if (!tied && level >= MSD_MAX_LEVELS) {
+        merge_sort_text(keys, tmp, n, depth, desc);
+    } else if (!tied) {
+        size_t start[256];
+        size_t offset = 0;
+        for (unsigned d = 0; d < 256; d++) {
+            unsigned bucket = desc ? 255 - d : d;
+            start[bucket]   = offset;
+            offset += count[bucket];
+        }
+
+        size_t next[256];
+        memcpy(next, start, sizeof(next));
+        for (size_t i = 0; i < n; i++) {
+            tmp[next[(keys[i].key >> shift) & 0xff]++] = keys[i];
+        }
+        memcpy(keys, tmp, sizeof(SortKey) * n);
+
+        for (unsigned d = 0; d < 256; d++) {
+            if (count[d] > 1) {
+                msd_sort_text(keys + start[d], tmp, count[d], depth, byte + 1, level + 1, desc);
+            }
+        }
+    }
+
+    // Callers compare the prefix they passed in, which the whole bucket shares
+    if (depth != entry) {
+        for (size_t i = 0; i < n; i++) {
+            keys[i].key = shared;
+        }
+    }
+}
+
+/**
+ * MSD radix sort of text keys, using `tmp` (n keys) as the bucket buffer.
+ */
+static void sort_text_run(SortKey* keys, SortKey* tmp, size_t n, bool desc) {
+    if (n > 1) {
+        msd_sort_text(keys, tmp, n, 0, 0, 0, desc);
+    }
+}
+
+// =============================================================================
+// PARALLEL SORT
+// =============================================================================
+
+/** Sorts one run of keys in place. */
+typedef void (*SortRunFn)(SortKey* keys, SortKey* tmp, size_t n, bool desc);
+
+/** Orders two keys; keys that compare equal are kept in input order by the merge. */
+typedef int (*SortCompareFn)(const SortKey* a, const SortKey* b, bool desc);
+
+/** One chunk sorted by a worker. */
+typedef struct {
+    SortRunFn sort;
+    SortKey* keys;
+    SortKey* tmp;
+    size_t n;
+    bool desc;
+} RunTask;
+
+/** One slice of a merge of two adjacent sorted runs. */
+typedef struct {
+    SortCompareFn compare;
+    const SortKey* a;  // Left run
+    size_t na;
+    const SortKey* b;  // Right run, whose keys go after equal keys of the left run
+    size_t nb;
+    SortKey* out;      // Output of the whole merge (na + nb keys)
+    size_t first;      // Output positions [first, last) produced by this slice
+    size_t last;
+    bool desc;
+} MergeTask;
+
+/**
+ * Returns the number of keys of `a` among the first `d` keys of the merged output.
+ */
+static size_t merge_split(const MergeTask* t, size_t d) {
+    size_t lo = d > t->nb ? d - t->nb : 0;
+    size_t hi = d < t->na ? d : t->na;
+
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = d - i - 1;
+        if (t->compare(&t->a[i], &t->b[j], t->desc) <= 0) {
+            lo = i + 1;  // a[i] is output before b[j], so more of `a` is included
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Merges one slice of two sorted runs.
+ */
+static void* merge_worker(void* arg) {
+    const MergeTask* t = arg;
+    size_t i           = merge_split(t, t->first);
+    size_t j           = t->first - i;
+
+    for (size_t d = t->first; d < t->last; d++) {
+        if (j == t->nb || (i < t->na && t->compare(&t->a[i], &t->b[j], t->desc) <= 0)) {
+            t->out[d] = t->a[i++];
+        } else {
+            t->out[d] = t->b[j++];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Sorts one chunk.
+ */
+static void* run_worker(void* arg) {
+    const RunTask* t = arg;
+    t->sort(t->keys, t->tmp, t->n, t->desc);
+    return NULL;
+}
+
+/**
+ * Runs `count` tasks, each on its own thread (the first on the calling thread).
+ * Tasks whose thread can't be started run on the calling thread instead.
+ */
+static void run_tasks(void* (*worker)(void*), void* tasks, size_t task_size, size_t count) {
+    char* base = tasks;
+
+#ifdef _WIN32
+    for (size_t i = 0; i < count; i++) {
+        worker(base + i * task_size);
+    }
+#else
+    pthread_t threads[MAX_SORT_TASKS];
+    bool started[MAX_SORT_TASKS] = {false};
+
+    for (size_t i = 1; i < count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, worker, base + i * task_size) == 0;
+    }
+    worker(base);
+    for (size_t i = 1; i < count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            worker(base + i * task_size);
+        }
+    }
+#endif
+}
+
+/** Thread count set by sort_keys_set_threads(), 0 for the default. */
+static size_t forced_threads = 0;
+
+/**
+ * Overrides the number of sort threads.
+ */
+void sort_keys_set_threads(size_t threads) { forced_threads = threads; }
+
+/**
+ * Returns the number of threads worth using for `n` keys.
+ */
+static size_t sort_thread_count(size_t n) {
+    if (forced_threads > 0) {
+        size_t threads = forced_threads < MAX_SORT_THREADS ? forced_threads : MAX_SORT_THREADS;
+        return threads < n ? threads : (n > 0 ? n : 1);
+    }
+
+    long cores = 1;
+#ifndef _WIN32
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    size_t threads = cores > 1 ? (size_t)cores : 1;
+    if (threads > MAX_SORT_THREADS) {
+        threads = MAX_SORT_THREADS;
+    }
+    if (threads > n / PARALLEL_MIN_KEYS) {
+        threads = n / PARALLEL_MIN_KEYS;
+    }
+    return threads > 1 ? threads : 1;
+}
+
+/**
+ * Sorts keys by splitting them into one chunk per thread, sorting the chunks in parallel and
+ * merging adjacent runs pairwise. Every merge round is split across all threads by output
+ * position, so the last rounds keep every core busy too.
+ * @return true on success, false on allocation failure (keys unchanged).
+ */
+static bool parallel_sort(SortKey* keys, size_t n, bool desc, SortRunFn sort, SortCompareFn compare) {
+    if (n < 2) {
+        return true;
+    }
+
+    SortKey* tmp = malloc(sizeof(SortKey) * n);
+    if (tmp == NULL) {
+        return false;
+    }
+
+    size_t threads = sort_thread_count(n);
+    if (threads == 1) {
+        sort(keys, tmp, n, desc);
+        free(tmp);
+        return true;
+    }
+
+    // Chunks are contiguous, so a left run always holds the earlier rows of a merge
+    size_t bounds[MAX_SORT_THREADS + 1];
+    RunTask runs[MAX_SORT_THREADS];
+    for (size_t i = 0; i <= threads; i++) {
+        bounds[i] = n / threads * i + (i < n % threads ? i : n % threads);
+    }
+    for (size_t i = 0; i < threads; i++) {
+        runs[i] = (RunTask){sort, keys + bounds[i], tmp + bounds[i], bounds[i + 1] - bounds[i], desc};
+    }
+    run_tasks(run_worker, runs, sizeof(RunTask), threads);
+
+    SortKey* src     = keys;
+    SortKey* dst     = tmp;
+    size_t run_count = threads;
+    while (run_count > 1) {
+        MergeTask merges[MAX_SORT_TASKS];
+        size_t task_count = 0;
+
+        for (size_t r = 0; r < run_count; r += 2) {
+            size_t lo  = bounds[r];
+            size_t mid = bounds[r + 1];
+            size_t hi  = r + 1 < run_count ? bounds[r + 2] : mid;
+
+            // Each merge gets a share of the threads proportional to its size
+            size_t slices = (threads * (hi - lo) + n - 1) / n;
+            for (size_t s = 0; s < slices; s++) {
+                merges[task_count++] = (MergeTask){.compare = compare,
+                                                   .a       = src + lo,
+                                                   .na      = mid - lo,
+                                                   .b       = src + mid,
+                                                   .nb      = hi - mid,
+                                                   .out     = dst + lo,
+                                                   .first   = (hi - lo) * s / slices,
+                                                   .last    = (hi - lo) * (s + 1) / slices,
+                                                   .desc    = desc};
+            }
+        }
+        run_tasks(merge_worker, merges, sizeof(MergeTask), task_count);
+
+        // Merged runs span every other boundary
+        size_t kept = 0;
+        for (size_t r = 0; r <= run_count; r += 2) {
+            bounds[kept++] = bounds[r];
+        }
+        if (run_count % 2 != 0) {
+            bounds[kept++] = bounds[run_count];
+        }
+        run_count = kept - 1;
+
+        SortKey* swap = src;
+        src           = dst;
+        dst           = swap;
+    }
+
+    if (src != keys) {
+        memcpy(keys, src, sizeof(SortKey) * n);
+    }
+    free(tmp);
+    return true;
+}
+
+// =============================================================================
+// TOP-K SELECTION
+// =============================================================================
+
+/**
+ * Orders two keys, breaking ties by row, so that no two keys are equal.
+ */
+static int compare_ranked(SortCompareFn compare, const SortKey* a, const SortKey* b, bool desc) {
+    int result = compare(a, b, desc);
+    return result != 0 ? result : (a->row > b->row) - (a->row < b->row);
+}
+
+/**
+ * Restores the max-heap property (the last key in sort order on top) below position `i`.
+ */
+static void sift_down(SortKey* heap, size_t n, size_t i, SortCompareFn compare, bool desc) {
+    SortKey k = heap[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && compare_ranked(compare, &heap[child + 1], &heap[child], desc) > 0) {
+            child++;
+        }
+        if (compare_ranked(compare, &heap[child], &k, desc) <= 0) break;
+        heap[i] = heap[child];
+        i       = child;
+    }
+    heap[i] = k;
+}
+
+/**
+ * Moves the first `keep` keys in sort order to the front, sorted, in O(n log keep) time.
+ * A max-heap holds the best keys seen so far; a key that beats the heap's worst replaces it.
+ * The keys after `keep` are left in unspecified order.
+ */
+static void select_top(SortKey* keys, size_t n, size_t keep, SortCompareFn compare, bool desc) {
+    for (size_t i = keep / 2; i-- > 0;) {
+        sift_down(keys, keep, i, compare, desc);
+    }
+
+    for (size_t i = keep; i < n; i++) {
+        if (compare_ranked(compare, &keys[i], &keys[0], desc) < 0) {
+            SortKey worst = keys[0];
+            keys[0]       = keys[i];
+            keys[i]       = worst;
+            sift_down(keys, keep, 0, compare, desc);
+        }
+    }
+
+    // Heap sort the survivors: the worst is moved to the end each time
+    for (size_t end = keep; end > 1; end--) {
+        SortKey worst = keys[0];
+        keys[0]       = keys[end - 1];
+        keys[end - 1] = worst;
+        sift_down(keys, end - 1, 0, compare, desc);
+    }
+}
+
+/**
+ * Sorts the keys, or only selects and sorts the first `keep` when that is much cheaper.
+ */
+static bool sort_or_select(SortKey* keys, size_t n, size_t keep, bool desc, SortRunFn sort, SortCompareFn compare) {
+    if (keep == 0) {
+        return true;
+    }
+    if (keep <= n / TOP_K_RATIO) {
+        select_top(keys, n, keep, compare, desc);
+        return true;
+    }
+    return parallel_sort(keys, n, desc, sort, compare);
+}
+
+/**
+ * Sorts number keys with an LSD radix sort per thread and a parallel merge.
+ */
+bool sort_keys_numbers(SortKey* keys, size_t n, size_t keep, bool desc) {
+    return sort_or_select(keys, n, keep, desc, lsd_sort_numbers, compare_number_keys);
+}
+
+/**
+ * Sorts text keys with an MSD radix sort per thread and a parallel merge.
+ */
+bool sort_keys_text(SortKey* keys, size_t n, size_t keep, bool desc) {
+    return sort_or_select(keys, n, keep, desc, sort_text_run, compare_text_keys);
+}
+
+/**
+ * Sorts composite keys with a comparison sort per thread and a parallel merge.
+ */
+bool sort_keys_composite(SortKey* keys, size_t n, size_t keep) {
+    return sort_or_select(keys, n, keep, false, sort_composite_run, compare_composite_keys);
+}
@@ -0,0 +1,140 @@
+#include "../include/timestamp.h"
+
+/**
+ * Reads exactly `n` ASCII digits at `*p` (bounded by `end`) and advances past them.
+ * @return true if all `n` bytes were digits.
+ */
+static bool read_digits(const char** p, const char* end, int n, int* out) {
+    if (end - *p < n) {
+        return false;
+    }
+
+    int value = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned d = (unsigned)((*p)[i] - '0');
+        if (d > 9) {
+            return false;
+        }
+        value = value * 10 + (int)d;
+    }
+
+    *p += n;
+    *out = value;
+    return true;
+}
+
+/**
+ * Returns the number of days in a month of the proleptic Gregorian calendar.
+ */
+static int days_in_month(int year, int month) {
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap                 = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return (month == 2 && leap) ? 29 : days[month - 1];
+}
+
+/**
+ * Converts a civil date to days since 1970-01-01 (Howard Hinnant's days_from_civil).
+ */
+static int64_t days_from_civil(int year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ * Parses an ISO-8601 date or timestamp.
+ */
+bool parse_timestamp(const char* text, size_t len, int64_t* out) {
+    const char* p   = text;
+    const char* end = text + len;
+    int year, month, day;
+
+    // Date: YYYY-MM-DD
+    if (!read_digits(&p, end, 4, &year) || p == end || *p++ != '-' || !read_digits(&p, end, 2, &month) ||
+        p == end || *p++ != '-' || !read_digits(&p, end, 2, &day)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > days_in_month(year, month)) {
+        return false;
+    }
+
+    int64_t micros = days_from_civil(year, month, day) * 86400 * TIMESTAMP_PER_SECOND;
+    if (p == end) {
+        *out = micros;
+        return true;
+    }
+
+    // Time: [T ]HH:MM[:SS[.ffffff]]
+    if (*p != 'T' && *p != 't' && *p != ' ') {
+        return false;
+    }
+    p++;
+
+    int hour, minute, second = 0;
+    if (!read_digits(&p, end, 2, &hour) || p == end || *p++ != ':' || !read_digits(&p, end, 2, &minute)) {
+        return false;
+    }
+    if (p < end && *p == ':') {
+        p++;
+        if (!read_digits(&p, end, 2, &second)) {
+            return false;
+        }
+    }
+    if (hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    int64_t fraction = 0;
+    if (p < end && (*p == '.' || *p == ',')) {
+        p++;
+        int digits = 0;
+        while (p < end && (unsigned)(*p - '0') <= 9) {
+            if (digits < 6) {
+                fraction = fraction * 10 + (*p - '0');
+            }
+            digits++;
+            p++;
+        }
+        if (digits == 0) {
+            return false;
+        }
+        for (; digits < 6; digits++) {
+            fraction *= 10;
+        }
+    }
+
+    micros += ((int64_t)hour * 3600 + minute * 60 + second) * TIMESTAMP_PER_SECOND + fraction;
+
+    // Zone: Z | +HH | +HHMM | +HH:MM (and '-')
+    if (p < end && (*p == 'Z' || *p == 'z')) {
+        p++;
+    } else if (p < end && (*p == '+' || *p == '-')) {
+        int sign = (*p++ == '-') ? -1 : 1;
+        int off_hour, off_minute = 0;
+        if (!read_digits(&p, end, 2, &off_hour)) {
+            return false;
+        }
+        if (p < end && *p == ':') {
+            p++;
+            if (!read_digits(&p, end, 2, &off_minute)) {
+                return false;
+            }
+        } else if (p < end && !read_digits(&p, end, 2, &off_minute)) {
+            return false;
+        }
+        if (off_hour > 23 || off_minute > 59) {
+            return false;
+        }
+        micros -= sign * ((int64_t)off_hour * 3600 + off_minute * 60) * TIMESTAMP_PER_SECOND;
+    }
+
+    if (p != end) {
+        return false;
+    }
+
+    *out = micros;
+    return true;
+}
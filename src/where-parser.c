@@ -1,5 +1,10 @@
 #include "../include/where-parser.h"
 #include <ctype.h>
+#include "../include/ascii-fold.h"
+#include "../include/expr.h"
+#include "../include/hash-set.h"
+#include "../include/regex-dfa.h"
+#include "../include/timestamp.h"
 #include <solidc/cstr.h>
 #include <solidc/str_utils.h>
 #include <stdio.h>
@@ -18,60 +23,332 @@ static ASTNode* parse_expression(Arena* arena, char** stream);
  */
 extern ssize_t find_column_by_name(const Row* header, const char* name);
 
+/**
+ * Finds the IN keyword: the whole word "in" followed by a '(' list or an @file reference.
+ * @param s Condition string.
+ * @return Pointer to the keyword, or NULL if the condition is not an IN condition.
+ */
+static char* find_in_keyword(char* s) {
+    for (char* p = strcasestr(s, "in"); p != NULL; p = strcasestr(p + 2, "in")) {
+        if (p == s || !isspace((unsigned char)p[-1])) continue;
+
+        char* q = p + 2;
+        if (!isspace((unsigned char)*q) && *q != '(' && *q != '@') continue;
+        while (isspace((unsigned char)*q)) q++;
+
+        if (*q == '(' || *q == '@') return p;
+    }
+    return NULL;
+}
+
+/**
+ * Adds one list item to the set after trimming whitespace and optional matching quotes.
+ */
+static bool add_in_value(StringSet* set, char* item) {
+    item       = trim_string(item);
+    size_t len = strlen(item);
+
+    if (len >= 2 && (item[0] == '\'' || item[0] == '"') && item[len - 1] == item[0]) {
+        item++;
+        len -= 2;
+    }
+    return string_set_add(set, item, len);
+}
+
+/**
+ * Builds the value set of an inline list "(a, b, c)". Quoted items may contain commas.
+ */
+static StringSet* parse_in_list(Arena* arena, char* list) {
+    size_t len = strlen(list);
+    if (len < 2 || list[0] != '(' || list[len - 1] != ')') {
+        fprintf(stderr, "Error: IN list must be enclosed in parentheses: '%s'\n", list);
+        return NULL;
+    }
+    list[len - 1] = '\0';
+    list++;
+
+    size_t expected = 1;
+    for (const char* p = list; *p; p++) {
+        if (*p == ',') expected++;
+    }
+
+    StringSet* set = string_set_create(arena, expected);
+    if (!set) return NULL;
+
+    char quote = 0;
+    char* item = list;
+    for (char* p = list;; p++) {
+        if (quote) {
+            if (*p == quote) quote = 0;
+            if (*p != '\0') continue;
+        } else if (*p == '\'' || *p == '"') {
+            quote = *p;
+            continue;
+        }
+
+        if (*p == ',' || *p == '\0') {
+            bool last = (*p == '\0');
+            *p        = '\0';
+            if (!add_in_value(set, item)) return NULL;
+            if (last) break;
+            item = p + 1;
+        }
+    }
+    return set;
+}
+
+/**
+ * Builds the value set of "@path": one value per line, blank lines ignored.
+ */
+static StringSet* load_in_file(Arena* arena, const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open IN list file '%s'\n", path);
+        return NULL;
+    }
+
+    size_t size = 0;
+    size_t cap  = 1 << 16;
+    char* data  = malloc(cap);
+    size_t n;
+    while (data && (n = fread(data + size, 1, cap - size - 1, fp)) > 0) {
+        size += n;
+        if (cap - size - 1 == 0) {
+            char* grown = realloc(data, cap * 2);
+            if (!grown) {
+                free(data);
+                data = NULL;
+                break;
+            }
+            data = grown;
+            cap *= 2;
+        }
+    }
+    fclose(fp);
+
+    if (!data) {
+        fprintf(stderr, "Error: Memory allocation failed reading '%s'\n", path);
+        return NULL;
+    }
+    data[size] = '\0';
+
+    size_t expected = 1;
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] == '\n') expected++;
+    }
+
+    StringSet* set = string_set_create(arena, expected);
+    char* line     = data;
+    while (set && line < data + size) {
+        char* end = memchr(line, '\n', (size_t)(data + size - line));
+        if (!end) end = data + size;
+        *end = '\0';
+
+        char* item = trim_string(line);
+        if (*item != '\0' && !string_set_add(set, item, strlen(item))) set = NULL;
+        line = end + 1;
+    }
+
+    free(data);
+    return set;
+}
+
+/**
+ * Parses "col in (a, b, ...)" or "col in @file" into a WhereClause.
+ */
+static WhereClause* parse_in_condition(Arena* arena, char* cond_str, char* in_pos) {
+    *in_pos        = '\0';
+    char* col_name = trim_string(cond_str);
+    char* value    = trim_string(in_pos + 2);
+
+    if (!col_name || !*col_name || !value || !*value) {
+        fprintf(stderr, "Error: Invalid IN condition\n");
+        return NULL;
+    }
+
+    WhereClause* wc = ARENA_ALLOC_ZERO(arena, WhereClause);
+    if (!wc) {
+        fprintf(stderr, "Error: Memory allocation failed for WhereClause\n");
+        return NULL;
+    }
+
+    wc->column_name = arena_strdup(arena, col_name);
+    wc->value       = arena_strdup(arena, value);
+    if (!wc->column_name || !wc->value) {
+        fprintf(stderr, "Error: Memory allocation failed for IN condition\n");
+        return NULL;
+    }
+
+    wc->op         = OP_IN;
+    wc->column_idx = (size_t)-1;
+    wc->set        = (*value == '@') ? load_in_file(arena, trim_string(value + 1)) : parse_in_list(arena, value);
+    if (!wc->set) return NULL;
+
+    return wc;
+}
+
+/**
+ * Finds an operator in a condition string.
+ * Word operators (contains, matches) must stand alone, so column names such as
+ * "matches_played" are not mistaken for operators.
+ * @return Position of the first occurrence, or NULL.
+ */
+static char* find_operator(char* s, const char* op) {
+    if (!isalpha((unsigned char)op[0])) {
+        return strstr(s, op);
+    }
+
+    size_t len = strlen(op);
+    for (char* p = strcasestr(s, op); p != NULL; p = strcasestr(p + 1, op)) {
+        bool starts = (p > s) && isspace((unsigned char)p[-1]);
+        bool ends   = p[len] == '\0' || isspace((unsigned char)p[len]);
+        if (starts && ends) return p;
+    }
+    return NULL;
+}
+
+/**
+ * Comparison operators, listed longest first so that on a tie ">=" wins over ">".
+ */
+static const char* const operators[] = {
+    "contains",  // Length 8
+    "between",   // Length 7
+    "matches",   // Length 7
+    ">=",        // Length 2
+    "<=",        // Length 2
+    "==",        // Length 2
+    "!=",        // Length 2
+    ">",         // Length 1
+    "<",         // Length 1
+    "=",         // Length 1
+    "~"          // Length 1
+};
+
+/** The CompareOp of each entry of `operators`. */
+static const CompareOp operator_ops[] = {OP_CONTAINS,   OP_BETWEEN, OP_MATCHES, OP_GREATER_EQ, OP_LESS_EQ, OP_EQUALS_CS,
+                                         OP_NOT_EQUALS, OP_GREATER, OP_LESS,    OP_EQUALS,     OP_MATCHES};
+
+/**
+ * Finds the operator of a condition: the leftmost one, and on a tie the longest, so
+ * "age>=25" splits at ">=". IN counts only as found by find_in_keyword(), so
+ * "note = stuck in (traffic)" is an equality whose value mentions "in".
+ * @param op Output: the operator found.
+ * @param len Output: its length in the condition text.
+ * @return Position of the operator, or NULL if the condition has none.
+ */
+static char* find_condition_operator(char* s, CompareOp* op, size_t* len) {
+    char* op_pos = find_in_keyword(s);
+    if (op_pos != NULL) {
+        *op  = OP_IN;
+        *len = 2;
+    }
+    for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++) {
+        char* pos = find_operator(s, operators[i]);
+        if (pos != NULL && (op_pos == NULL || pos < op_pos)) {
+            op_pos = pos;
+            *op    = operator_ops[i];
+            *len   = strlen(operators[i]);
+        }
+    }
+    return op_pos;
+}
+
+/**
+ * Finds the operator of the condition text in [start, end), as find_condition_operator()
+ * does, without copying it.
+ */
+static char* find_operator_before(char* start, char* end, CompareOp* op) {
+    char saved = *end;
+    *end       = '\0';
+
+    size_t len;
+    char* pos = find_condition_operator(start, op, &len);
+    *end      = saved;
+    return pos;
+}
+
+/**
+ * Parses a numeric literal, allowing surrounding whitespace.
+ * @return true if the whole string is a number.
+ */
+static bool parse_number_literal(const char* text, double* out) {
+    char* end;
+    *out = strtod(text, &end);
+    if (end == text) return false;
+    while (isspace((unsigned char)*end)) end++;
+    return *end == '\0';
+}
+
+/**
+ * Parses an ISO-8601 timestamp literal, allowing surrounding whitespace.
+ * @return true if the whole string is a timestamp.
+ */
+static bool parse_time_literal(const char* text, int64_t* out) {
+    while (isspace((unsigned char)*text)) text++;
+    size_t len = strlen(text);
+    while (len > 0 && isspace((unsigned char)text[len - 1])) len--;
+    return parse_timestamp(text, len, out);
+}
+
+/**
+ * Parses the literal of a one-sided comparison: a number, or failing that a timestamp.
+ */
+static void parse_bound_literal(WhereClause* wc) {
+    wc->has_number = parse_number_literal(wc->value, &wc->number);
+    if (!wc->has_number) {
+        wc->is_time = parse_time_literal(wc->value, &wc->time);
+    }
+}
+
+/**
+ * Parses the "low AND high" value of a BETWEEN condition into the clause bounds.
+ * Both bounds must be numbers or both timestamps; otherwise the clause matches nothing.
+ */
+static bool parse_between_bounds(WhereClause* wc) {
+    char* and_pos = find_operator(wc->value, "and");
+    if (and_pos == NULL) {
+        fprintf(stderr, "Error: BETWEEN needs 'low AND high', got '%s'\n", wc->value);
+        return false;
+    }
+
+    *and_pos       = '\0';
+    bool low       = parse_number_literal(wc->value, &wc->number);
+    bool high      = parse_number_literal(and_pos + 3, &wc->upper);
+    wc->has_number = low && high;
+    if (!wc->has_number) {
+        wc->is_time = parse_time_literal(wc->value, &wc->time) && parse_time_literal(and_pos + 3, &wc->time_upper);
+    }
+    *and_pos = ' ';  // Keep the original text for messages
+    return true;
+}
+
 /**
  * Helper to parse a single raw condition string (e.g. "age > 25") into a WhereClause struct.
  * This reuses the logic from your original linear parser but applies it to a leaf node.
  *
- * Operators are now checked from longest to shortest to avoid partial matches.
- * For example, ">=" must be checked before ">" to prevent "age>=25" from matching ">".
+ * The operator is found by find_condition_operator().
  */
 static WhereClause* parse_single_condition(Arena* arena, char* cond_str) {
     // Trim input
     cond_str = trim_string(cond_str);
     if (!cond_str || !*cond_str) return NULL;
 
-    // Check operators from longest to shortest to avoid partial matches
-    // Old order: ">=", "<=", "!=", "contains", ">", "<", "="
-    // Problem: If checking ">" before ">=", then "age>=25" would match ">" first
-    //
-    // New order groups by length and checks longest first:
-    // - Length 8: "contains"
-    // - Length 2: ">=", "<=", "!="
-    // - Length 1: ">", "<", "="
-    const char* operators[] = {
-        "contains",  // Length 8 - must be first
-        ">=",        // Length 2
-        "<=",        // Length 2
-        "!=",        // Length 2
-        ">",         // Length 1
-        "<",         // Length 1
-        "="          // Length 1
-    };
-
-    CompareOp ops[] = {OP_CONTAINS, OP_GREATER_EQ, OP_LESS_EQ, OP_NOT_EQUALS, OP_GREATER, OP_LESS, OP_EQUALS};
-
-    size_t num_ops = sizeof(operators) / sizeof(operators[0]);
-
-    char* op_pos       = NULL;
-    CompareOp found_op = OP_EQUALS;
+    // The leftmost operator splits column from value, so a value may itself contain
+    // operator characters (e.g. "line ~ a=\d+")
     size_t op_len      = 0;
-
-    // Find operator - now checking longest first
-    for (size_t i = 0; i < num_ops; i++) {
-        char* pos = strcasestr(cond_str, operators[i]);
-        if (pos != NULL) {
-            op_pos   = pos;
-            found_op = ops[i];
-            op_len   = strlen(operators[i]);
-            break;  // Safe to break now because we check longest first
-        }
-    }
+    CompareOp found_op = OP_EQUALS;
+    char* op_pos       = find_condition_operator(cond_str, &found_op, &op_len);
 
     if (op_pos == NULL) {
         fprintf(stderr, "Error: No valid operator in clause: '%s'\n", cond_str);
         return NULL;
     }
 
+    // The value list of IN may itself contain operator characters, which are ignored after it
+    if (found_op == OP_IN) {
+        return parse_in_condition(arena, cond_str, op_pos);
+    }
+
     // Split string at operator
     *op_pos        = '\0';
     char* col_name = cond_str;
@@ -107,8 +384,24 @@ static WhereClause* parse_single_condition(Arena* arena, char* cond_str) {
 
     wc->op         = found_op;
     wc->column_idx = (size_t)-1;
-    wc->is_numeric =
-        (found_op == OP_GREATER || found_op == OP_LESS || found_op == OP_GREATER_EQ || found_op == OP_LESS_EQ);
+
+    // "price * qty > 1000": kept alongside the name, which wins if it turns out to be a column
+    wc->expr = expr_compile(arena, wc->column_name);
+
+    // Compile the pattern once; rows are matched with its lazily built DFA
+    if (found_op == OP_MATCHES) {
+        wc->regex = regex_compile(wc->value);
+        if (!wc->regex) return NULL;
+    }
+    wc->is_numeric = (found_op == OP_GREATER || found_op == OP_LESS || found_op == OP_GREATER_EQ ||
+                      found_op == OP_LESS_EQ || found_op == OP_BETWEEN);
+
+    // Parse the literal once here instead of once per row.
+    if (found_op == OP_BETWEEN) {
+        if (!parse_between_bounds(wc)) return NULL;
+    } else if (wc->is_numeric) {
+        parse_bound_literal(wc);
+    }
 
     return wc;
 }
@@ -137,6 +430,100 @@ static inline bool check_token(char** stream, const char* token) {
     return false;
 }
 
+/**
+ * Returns the ')' closing the IN list opened at `paren`, skipping quoted items, or NULL.
+ */
+static char* find_in_list_end(char* paren) {
+    char quote = 0;
+    for (char* p = paren + 1; *p; p++) {
+        if (quote) {
+            if (*p == quote) quote = 0;
+        } else if (*p == '\'' || *p == '"') {
+            quote = *p;
+        } else if (*p == ')') {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Finds the ')' matching the '(' at `paren`, skipping nested groups and quoted text.
+ * @return Pointer to the closing parenthesis, or NULL if it is missing.
+ */
+static char* find_group_end(char* paren) {
+    int depth  = 0;
+    char quote = 0;
+    for (char* p = paren; *p; p++) {
+        if (quote) {
+            if (*p == quote) quote = 0;
+        } else if (*p == '\'' || *p == '"') {
+            quote = *p;
+        } else if (*p == '(') {
+            depth++;
+        } else if (*p == ')' && --depth == 0) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Checks whether the '(' at `paren` groups arithmetic, as in "a * (b + c) > 5" or
+ * "(a + b) / 2 > 5", rather than conditions: it follows an arithmetic operator, or the
+ * group is followed by one or by a comparison.
+ * @param start Start of the condition, so nothing before it is looked at.
+ */
+static bool opens_arithmetic_group(const char* start, char* paren) {
+    const char* before = paren;
+    while (before > start && isspace((unsigned char)before[-1])) before--;
+    if (before > start && strchr("+-*/", before[-1]) != NULL) return true;
+
+    char* end = find_group_end(paren);
+    if (end == NULL) return false;
+    end++;
+    while (isspace((unsigned char)*end)) end++;
+
+    return (*end != '\0' && strchr("+-*/<>=!", *end) != NULL) || strncasecmp(end, "between ", 8) == 0;
+}
+
+/**
+ * Skips over a regex pattern starting at `p`, stopping at " AND ", " OR " or a ')'
+ * that closes an enclosing group. Parentheses, brackets and escapes inside the
+ * pattern belong to it.
+ * @return Position where the condition ends.
+ */
+static char* skip_regex_pattern(char* p) {
+    int depth = 0;
+
+    while (*p) {
+        if (*p == '\\' && p[1] != '\0') {
+            p += 2;
+            continue;
+        }
+
+        if (*p == '[') {
+            char* q = p + 1;
+            if (*q == '^') q++;
+            if (*q == ']') q++;
+            while (*q && *q != ']') q += (*q == '\\' && q[1] != '\0') ? 2 : 1;
+            p = *q ? q + 1 : q;
+            continue;
+        }
+
+        if (*p == '(') {
+            depth++;
+        } else if (*p == ')') {
+            if (depth == 0) break;
+            depth--;
+        } else if (depth == 0 && (strncasecmp(p, " AND ", 5) == 0 || strncasecmp(p, " OR ", 4) == 0)) {
+            break;
+        }
+        p++;
+    }
+    return p;
+}
+
 /**
  * Parses a "Factor": ( Expression ) OR Condition
  */
@@ -147,8 +534,8 @@ static ASTNode* parse_factor(Arena* arena, char** stream) {
     while (isspace((unsigned char)*s)) s++;
     *stream = s;
 
-    // Check for Parentheses
-    if (check_token(stream, "(")) {
+    // Check for Parentheses (unless they group arithmetic, as in "(a + b) * c > 5")
+    if (*s == '(' && !opens_arithmetic_group(s, s) && check_token(stream, "(")) {
         ASTNode* node = parse_expression(arena, stream);
         if (!node) return NULL;
 
@@ -163,10 +550,58 @@ static ASTNode* parse_factor(Arena* arena, char** stream) {
     char* start  = *stream;
     char* cursor = start;
 
+    // The AND inside "x between A and B" belongs to the condition
+    bool pending_between = false;
+
     // Advance cursor until we hit a reserved word or char
     while (*cursor) {
+        // Parentheses after the condition's operator are part of it, not a group
+        CompareOp op;
+        if (*cursor == '(' && find_operator_before(start, cursor + 1, &op) != NULL) {
+            // An IN list, or text in a value ("note = stuck in (traffic)")
+            char* end = op == OP_IN ? find_in_list_end(cursor) : find_group_end(cursor);
+            if (!end && op == OP_IN) {
+                fprintf(stderr, "Error: Unterminated IN list.\n");
+                return NULL;
+            }
+            if (end) {
+                cursor = end + 1;
+                continue;
+            }
+        }
+
+        // Everything after a regex operator is pattern text
+        if (*cursor == '~' || strncasecmp(cursor, " matches ", 9) == 0) {
+            cursor = skip_regex_pattern(cursor + (*cursor == '~' ? 1 : 9));
+            break;
+        }
+
+        // Parentheses inside an arithmetic expression belong to the condition
+        if (*cursor == '(' && opens_arithmetic_group(start, cursor)) {
+            char* end = find_group_end(cursor);
+            if (!end) {
+                fprintf(stderr, "Error: Mismatched parentheses.\n");
+                return NULL;
+            }
+            cursor = end + 1;
+            continue;
+        }
+
         if (*cursor == '(' || *cursor == ')') break;
 
+        // Only when BETWEEN is the condition's operator: "note contains between AND ..." is two conditions
+        if (strncasecmp(cursor, " BETWEEN ", 9) == 0 && find_operator_before(start, cursor + 8, &op) == cursor + 1 &&
+            op == OP_BETWEEN) {
+            pending_between = true;
+            cursor += 8;
+            continue;
+        }
+        if (pending_between && strncasecmp(cursor, " AND ", 5) == 0) {
+            pending_between = false;
+            cursor += 4;
+            continue;
+        }
+
         // Check for " AND " or " OR " boundaries (case insensitive)
         if (strncasecmp(cursor, " AND ", 5) == 0 || strncasecmp(cursor, " OR ", 4) == 0) {
             break;
@@ -262,6 +697,135 @@ static ASTNode* parse_expression(Arena* arena, char** stream) {
     return left;
 }
 
+/**
+ * Checks whether a condition is a one-sided numeric or timestamp bound that can join a range.
+ */
+static bool is_bound_clause(const WhereClause* wc) {
+    return (wc->has_number || wc->is_time) &&
+           (wc->op == OP_GREATER || wc->op == OP_GREATER_EQ || wc->op == OP_LESS || wc->op == OP_LESS_EQ);
+}
+
+/**
+ * Merges a lower and an upper bound on the same column into one OP_BETWEEN clause.
+ * @return The fused clause, or NULL if the pair does not form a range.
+ */
+static WhereClause* fuse_bounds(Arena* arena, const WhereClause* a, const WhereClause* b) {
+    bool a_lower = (a->op == OP_GREATER || a->op == OP_GREATER_EQ);
+    bool b_lower = (b->op == OP_GREATER || b->op == OP_GREATER_EQ);
+    if (a_lower == b_lower || a->is_time != b->is_time || strcasecmp(a->column_name, b->column_name) != 0) {
+        return NULL;
+    }
+
+    const WhereClause* lower = a_lower ? a : b;
+    const WhereClause* upper = a_lower ? b : a;
+
+    WhereClause* wc = ARENA_ALLOC_ZERO(arena, WhereClause);
+    if (!wc) return NULL;  // Not fatal: the bounds are simply evaluated separately
+
+    *wc                 = *lower;
+    wc->op              = OP_BETWEEN;
+    wc->upper           = upper->number;
+    wc->time_upper      = upper->time;
+    wc->exclusive_lower = (lower->op == OP_GREATER);
+    wc->exclusive_upper = (upper->op == OP_LESS);
+    return wc;
+}
+
+/**
+ * Collects the operands of a chain of AND nodes, left to right.
+ */
+static void collect_conjuncts(ASTNode* node, ASTNode** out, size_t* count) {
+    if (node->type == NODE_LOGIC && node->logic_op == LOGIC_AND) {
+        collect_conjuncts(node->left, out, count);
+        collect_conjuncts(node->right, out, count);
+    } else {
+        out[(*count)++] = node;
+    }
+}
+
+/**
+ * Counts the operands of a chain of AND nodes.
+ */
+static size_t count_conjuncts(const ASTNode* node) {
+    if (node->type == NODE_LOGIC && node->logic_op == LOGIC_AND) {
+        return count_conjuncts(node->left) + count_conjuncts(node->right);
+    }
+    return 1;
+}
+
+/**
+ * Rewrites "x >= A AND x <= B" (in any order within an AND chain, with either
+ * strictness) into a single range condition, so the column is checked once per row.
+ * @return The rewritten subtree (unchanged if nothing could be fused).
+ */
+static ASTNode* fuse_range_conditions(Arena* arena, ASTNode* node) {
+    if (!node || node->type != NODE_LOGIC) return node;
+
+    if (node->logic_op == LOGIC_OR) {
+        node->left  = fuse_range_conditions(arena, node->left);
+        node->right = fuse_range_conditions(arena, node->right);
+        return node;
+    }
+
+    size_t count    = count_conjuncts(node);
+    ASTNode** terms = malloc(sizeof(ASTNode*) * count);
+    if (!terms) return node;
+
+    size_t n = 0;
+    collect_conjuncts(node, terms, &n);
+
+    for (size_t i = 0; i < n; i++) {
+        terms[i] = fuse_range_conditions(arena, terms[i]);
+    }
+
+    // Pair each bound with the first later bound on the same column facing the other way
+    bool fused_any = false;
+    for (size_t i = 0; i < n; i++) {
+        if (terms[i] == NULL || terms[i]->type != NODE_CONDITION || !is_bound_clause(terms[i]->clause)) continue;
+
+        for (size_t j = i + 1; j < n; j++) {
+            if (terms[j] == NULL || terms[j]->type != NODE_CONDITION || !is_bound_clause(terms[j]->clause)) continue;
+
+            WhereClause* fused = fuse_bounds(arena, terms[i]->clause, terms[j]->clause);
+            if (fused) {
+                terms[i]->clause = fused;
+                terms[j]         = NULL;
+                fused_any        = true;
+                break;
+            }
+        }
+    }
+
+    if (!fused_any) {
+        free(terms);
+        return node;
+    }
+
+    // Rebuild a left-deep AND chain from the surviving terms
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (terms[i] != NULL) terms[kept++] = terms[i];
+    }
+
+    ASTNode* result = terms[0];
+    for (size_t i = 1; i < kept; i++) {
+        ASTNode* parent = ARENA_ALLOC_ZERO(arena, ASTNode);
+        if (!parent) {
+            // The old chain is still correct: each fused range implies the bound it absorbed
+            free(terms);
+            return node;
+        }
+        parent->type     = NODE_LOGIC;
+        parent->logic_op = LOGIC_AND;
+        parent->left     = result;
+        parent->right    = terms[i];
+        result           = parent;
+    }
+
+    free(terms);
+    return result;
+}
+
 /**
  * Entry point for parsing the where clause.
  */
@@ -293,10 +857,50 @@ bool parse_where_clause(Arena* arena, const char* where_str, WhereFilter* filter
         return false;
     }
 
+    filter->root = fuse_range_conditions(arena, filter->root);
+
     free(input);
     return (filter->root != NULL);
 }
 
+/**
+ * Releases compiled regexes in an AST (recursive).
+ */
+static void free_ast(ASTNode* node) {
+    if (!node) return;
+
+    if (node->type == NODE_LOGIC) {
+        free_ast(node->left);
+        free_ast(node->right);
+    } else if (node->clause && node->clause->regex) {
+        regex_free(node->clause->regex);
+        node->clause->regex = NULL;
+    }
+}
+
+/**
+ * Releases resources owned by the filter that do not live in the arena.
+ */
+void free_where_filter(WhereFilter* filter) {
+    if (filter) free_ast(filter->root);
+}
+
+/**
+ * Resolves the columns of an arithmetic left-hand side.
+ * Expressions are numbers, so '=', '==' and '!=' become numeric comparisons here.
+ */
+static void resolve_expression_clause(WhereClause* wc, const Row* header) {
+    if (wc->op == OP_EQUALS || wc->op == OP_EQUALS_CS || wc->op == OP_NOT_EQUALS) {
+        wc->is_numeric = true;
+        parse_bound_literal(wc);
+    } else if (!wc->is_numeric) {
+        fprintf(stderr, "Warning: Expression '%s' in where clause needs a numeric comparison.\n", wc->column_name);
+        return;
+    }
+
+    expr_resolve(wc->expr, header);
+}
+
 /**
  * Helper for Resolving Column Indices (Recursive)
  */
@@ -307,119 +911,583 @@ void resolve_ast_indices(ASTNode* node, const Row* header) {
         resolve_ast_indices(node->left, header);
         resolve_ast_indices(node->right, header);
     } else if (node->type == NODE_CONDITION) {
-        if (node->clause->column_idx == (size_t)-1) {
-            ssize_t idx = find_column_by_name(header, node->clause->column_name);
+        WhereClause* wc = node->clause;
+        if (wc->column_idx == (size_t)-1 && (wc->expr == NULL || !wc->expr->resolved)) {
+            ssize_t idx = find_column_by_name(header, wc->column_name);
             if (idx >= 0) {
-                node->clause->column_idx = (size_t)idx;
+                wc->column_idx = (size_t)idx;
+                wc->expr       = NULL;  // A column whose name merely looks like arithmetic
+            } else if (wc->expr != NULL) {
+                resolve_expression_clause(wc, header);
             } else {
-                fprintf(stderr, "Warning: Column '%s' in where clause not found in header.\n",
-                        node->clause->column_name);
+                fprintf(stderr, "Warning: Column '%s' in where clause not found in header.\n", wc->column_name);
             }
         }
     }
 }
 
+/** The two ways a value can miss a range condition. */
+typedef enum {
+    RANGE_BELOW,  // Under the lower bound of >, >= or BETWEEN
+    RANGE_ABOVE,  // Over the upper bound of <, <= or BETWEEN
+} RangeSide;
+
 /**
- * Evaluates a where clause against a row.
- * @param row The row to check.
- * @param clause The where clause.
- * @return true if the row matches the clause, false otherwise.
+ * Checks whether a row's value misses a range condition on one side, parsing only the
+ * block that holds the row.
  */
-static bool evaluate_where_clause(const Row* row, const WhereClause* clause) {
-    if (row == NULL || clause == NULL) {
-        return true;
+static bool row_outside(ColumnCache* cache, const WhereClause* wc, size_t row, RangeSide side) {
+    bool lower = wc->op == OP_GREATER || wc->op == OP_GREATER_EQ || wc->op == OP_BETWEEN;
+    bool upper = wc->op == OP_LESS || wc->op == OP_LESS_EQ || wc->op == OP_BETWEEN;
+    bool open  = side == RANGE_BELOW ? wc->op == OP_GREATER || (wc->op == OP_BETWEEN && wc->exclusive_lower)
+                                     : wc->op == OP_LESS || (wc->op == OP_BETWEEN && wc->exclusive_upper);
+
+    if (wc->is_time) {
+        int64_t v = column_cache_get_times_block(cache, wc->column_idx, row)->values[row];
+        if (side == RANGE_BELOW) {
+            return lower && (open ? v <= wc->time : v < wc->time);
+        }
+        int64_t bound = wc->op == OP_BETWEEN ? wc->time_upper : wc->time;
+        return upper && (open ? v >= bound : v > bound);
     }
 
-    if (clause->column_idx >= row->count) {
-        return false;
+    double v = column_cache_get_block(cache, wc->column_idx, row)->values[row];
+    if (side == RANGE_BELOW) {
+        return lower && (open ? v <= wc->number : v < wc->number);
+    }
+    double bound = wc->op == OP_BETWEEN ? wc->upper : wc->number;
+    return upper && (open ? v >= bound : v > bound);
+}
+
+/**
+ * Returns the first row of [lo, hi) for which row_outside() equals `outside`, given that
+ * it switches only once over the range.
+ */
+static size_t search_rows(ColumnCache* cache, const WhereClause* wc, size_t lo, size_t hi, RangeSide side,
+                          bool outside) {
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (row_outside(cache, wc, mid, side) == outside) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Finds the row range of one condition if its column is known to be sorted.
+ */
+static void attach_sorted_range(ColumnCache* cache, WhereClause* wc) {
+    wc->has_range = false;
+
+    bool range_op = wc->op == OP_GREATER || wc->op == OP_GREATER_EQ || wc->op == OP_LESS || wc->op == OP_LESS_EQ ||
+                    wc->op == OP_BETWEEN;
+    if (!range_op || wc->selection != NULL || wc->expr != NULL || wc->column_idx >= cache->col_count ||
+        (!wc->has_number && !wc->is_time)) {
+        return;
     }
 
-    const char* field = row->fields[clause->column_idx];
-    if (field == NULL) {
-        field = "";
+    // Every row must hold a value, or a gap could hide a match from the search
+    uint8_t order = wc->is_time ? column_cache_time_order(cache, wc->column_idx)
+                                : column_cache_order(cache, wc->column_idx);
+    if (!(order & COLUMN_ORDER_DENSE) || !(order & (COLUMN_ORDER_ASC | COLUMN_ORDER_DESC))) {
+        return;
     }
 
-    // Trim the field for comparison (especially important for numeric comparisons)
-    // Note: This creates a temporary copy for safety
-    char* field_trimmed = trim_string((char*)field);
-    if (!field_trimmed) {
-        field_trimmed = (char*)field;
+    // Allocates the vector, so that the probes below only parse blocks
+    bool ready = wc->is_time ? column_cache_get_times_block(cache, wc->column_idx, 0) != NULL
+                             : column_cache_get_block(cache, wc->column_idx, 0) != NULL;
+    if (!ready) {
+        return;
     }
 
+    // Rows under the range come first in ascending order, rows over it in descending order
+    size_t n           = cache->row_count;
+    RangeSide leading  = (order & COLUMN_ORDER_ASC) ? RANGE_BELOW : RANGE_ABOVE;
+    RangeSide trailing = (order & COLUMN_ORDER_ASC) ? RANGE_ABOVE : RANGE_BELOW;
+
+    wc->range_start = search_rows(cache, wc, 0, n, leading, false);
+    wc->range_end   = search_rows(cache, wc, wc->range_start, n, trailing, true);
+    wc->has_range   = true;
+}
+
+/**
+ * Finds the row ranges of range conditions on sorted columns.
+ */
+void attach_sorted_ranges(ColumnCache* cache, ASTNode* node) {
+    if (node == NULL) return;
+
+    if (node->type == NODE_LOGIC) {
+        attach_sorted_ranges(cache, node->left);
+        attach_sorted_ranges(cache, node->right);
+    } else if (node->type == NODE_CONDITION) {
+        attach_sorted_range(cache, node->clause);
+    }
+}
+
+/**
+ * Evaluates a text operator (contains, =, ==, !=, in, matches) against a single cell.
+ * The cell is compared through its trimmed span, so the row itself is never modified.
+ * @param field The raw cell text.
+ * @param info The cell's field info.
+ * @param clause The where clause.
+ * @param value_len Length of clause->value.
+ * @return true if the cell matches the clause, false otherwise.
+ */
+static bool evaluate_text_clause(const char* field, const FieldInfo* info, const WhereClause* clause,
+                                 size_t value_len) {
+    size_t len        = 0;
+    const char* start = field_trimmed(field, info, &len);
+
     switch (clause->op) {
         case OP_CONTAINS:
-            return strcasestr(field_trimmed, clause->value) != NULL;
+            // The needle was trimmed at parse time, so no match can reach the cell's trailing blanks
+            return value_len <= len && strcasestr(start, clause->value) != NULL;
 
-        case OP_EQUALS: {
-            // For equals, trim whitespace from both sides before comparing
-            int result = strcasecmp(field_trimmed, clause->value);
-            return result == 0;
-        }
+        case OP_EQUALS:
+            return len == value_len && ascii_equal_nocase(start, clause->value, len);
 
-        case OP_NOT_EQUALS: {
-            int result = strcasecmp(field_trimmed, clause->value);
-            return result != 0;
-        }
+        case OP_EQUALS_CS:
+            return len == value_len && memcmp(start, clause->value, len) == 0;
+
+        case OP_NOT_EQUALS:
+            return len != value_len || !ascii_equal_nocase(start, clause->value, len);
+
+        case OP_IN:
+            return string_set_contains(clause->set, start, len);
+
+        case OP_MATCHES:
+            return regex_search(clause->regex, start, len);
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Branch-free compare of up to 64 cached values against a literal, one bit per row.
+ * Kept as a plain loop over a contiguous double array so the compiler can vectorize it.
+ */
+#define NUMERIC_COMPARE_WORD(values, n, cmp, literal, bits)         \
+    do {                                                            \
+        for (size_t j_ = 0; j_ < (n); j_++) {                       \
+            (bits) |= (uint64_t)((values)[j_] cmp(literal)) << j_; \
+        }                                                           \
+    } while (0)
+
+/**
+ * Range variant of NUMERIC_COMPARE_WORD: both bounds are tested in the same pass,
+ * so each cached value is loaded once.
+ */
+#define NUMERIC_RANGE_WORD(values, n, lo_cmp, lo, hi_cmp, hi, bits)                            \
+    do {                                                                                       \
+        for (size_t j_ = 0; j_ < (n); j_++) {                                                  \
+            (bits) |= (uint64_t)(((values)[j_] lo_cmp(lo)) & ((values)[j_] hi_cmp(hi))) << j_; \
+        }                                                                                      \
+    } while (0)
+
+/**
+ * Dispatches a comparison clause to NUMERIC_COMPARE_WORD / NUMERIC_RANGE_WORD.
+ * Shared by the double and the timestamp paths, which differ only in the element type.
+ */
+#define NUMERIC_OP_WORD(clause, values, n, literal, upper, bits)                   \
+    do {                                                                           \
+        switch ((clause)->op) {                                                    \
+            case OP_GREATER:                                                       \
+                NUMERIC_COMPARE_WORD(values, n, >, literal, bits);                 \
+                break;                                                             \
+            case OP_LESS:                                                          \
+                NUMERIC_COMPARE_WORD(values, n, <, literal, bits);                 \
+                break;                                                             \
+            case OP_GREATER_EQ:                                                    \
+                NUMERIC_COMPARE_WORD(values, n, >=, literal, bits);                \
+                break;                                                             \
+            case OP_LESS_EQ:                                                       \
+                NUMERIC_COMPARE_WORD(values, n, <=, literal, bits);                \
+                break;                                                             \
+            case OP_EQUALS:                                                        \
+            case OP_EQUALS_CS:                                                     \
+                NUMERIC_COMPARE_WORD(values, n, ==, literal, bits);                \
+                break;                                                             \
+            case OP_NOT_EQUALS:                                                    \
+                NUMERIC_COMPARE_WORD(values, n, !=, literal, bits);                \
+                break;                                                             \
+            case OP_BETWEEN:                                                       \
+                if ((clause)->exclusive_lower && (clause)->exclusive_upper) {      \
+                    NUMERIC_RANGE_WORD(values, n, >, literal, <, upper, bits);     \
+                } else if ((clause)->exclusive_lower) {                            \
+                    NUMERIC_RANGE_WORD(values, n, >, literal, <=, upper, bits);    \
+                } else if ((clause)->exclusive_upper) {                            \
+                    NUMERIC_RANGE_WORD(values, n, >=, literal, <, upper, bits);    \
+                } else {                                                           \
+                    NUMERIC_RANGE_WORD(values, n, >=, literal, <=, upper, bits);   \
+                }                                                                  \
+                break;                                                             \
+            default:                                                               \
+                break;                                                             \
+        }                                                                          \
+    } while (0)
+
+/**
+ * Evaluates a numeric operator over a batch using the cached column vector.
+ * @param vec Pre-parsed column.
+ * @param clause The where clause.
+ * @param start First data row of the batch (multiple of 64).
+ * @param count Number of rows in the batch.
+ * @param out Output bitmap, one bit per batch row.
+ */
+static void evaluate_numeric_batch(const ColumnVector* vec, const WhereClause* clause, size_t start, size_t count,
+                                   uint64_t* out) {
+    const double literal = clause->number;
+    const double upper   = clause->upper;
+    size_t words         = BITMAP_WORDS(count);
+
+    for (size_t w = 0; w < words; w++) {
+        const double* values = vec->values + start + w * 64;
+        size_t n             = (count - w * 64) < 64 ? (count - w * 64) : 64;
+        uint64_t bits        = 0;
+
+        NUMERIC_OP_WORD(clause, values, n, literal, upper, bits);
+
+        // Cells that did not parse as numbers never match
+        out[w] = bits & vec->numeric[start / 64 + w];
+    }
+}
+
+/**
+ * Evaluates a timestamp comparison over a batch as plain integer compares.
+ * Same parameters as evaluate_numeric_batch.
+ */
+static void evaluate_time_batch(const TimeVector* tv, const WhereClause* clause, size_t start, size_t count,
+                                uint64_t* out) {
+    const int64_t literal = clause->time;
+    const int64_t upper   = clause->time_upper;
+    size_t words          = BITMAP_WORDS(count);
+
+    for (size_t w = 0; w < words; w++) {
+        const int64_t* values = tv->values + start + w * 64;
+        size_t n              = (count - w * 64) < 64 ? (count - w * 64) : 64;
+        uint64_t bits         = 0;
+
+        NUMERIC_OP_WORD(clause, values, n, literal, upper, bits);
+
+        // Cells that did not parse as timestamps never match
+        out[w] = bits & tv->valid[start / 64 + w];
+    }
+}
+
+_Static_assert(ZONE_ROWS % WHERE_BATCH_ROWS == 0, "a batch must not straddle two zone blocks");
 
+/**
+ * Checks whether any value in [zone->min, zone->max] can satisfy a numeric clause.
+ */
+static bool zone_may_match(const Zone* zone, const WhereClause* clause) {
+    switch (clause->op) {
         case OP_GREATER:
+            return zone->max > clause->number;
+        case OP_GREATER_EQ:
+            return zone->max >= clause->number;
         case OP_LESS:
+            return zone->min < clause->number;
+        case OP_LESS_EQ:
+            return zone->min <= clause->number;
+        case OP_BETWEEN: {
+            bool low_ok  = clause->exclusive_lower ? zone->max > clause->number : zone->max >= clause->number;
+            bool high_ok = clause->exclusive_upper ? zone->min < clause->upper : zone->min <= clause->upper;
+            return low_ok && high_ok;
+        }
+        default:
+            return true;
+    }
+}
+
+_Static_assert(WHERE_BATCH_ROWS <= EXPR_BATCH_ROWS, "a where batch must fit an expression batch");
+
+/**
+ * Evaluates a comparison whose left-hand side is an arithmetic expression.
+ * The expression is computed for the whole batch in one pass over the cached columns.
+ */
+static void evaluate_expression_batch(ColumnCache* cache, const WhereClause* clause, size_t start, size_t count,
+                                      const uint64_t* active, uint64_t* out) {
+    double values[WHERE_BATCH_ROWS];
+    uint64_t valid[WHERE_BATCH_WORDS];
+    size_t words = BITMAP_WORDS(count);
+
+    if (!clause->has_number || !expr_eval_batch(cache, clause->expr, start, count, values, valid)) {
+        memset(out, 0, sizeof(uint64_t) * words);
+        return;
+    }
+
+    const double literal = clause->number;
+    const double upper   = clause->upper;
+    for (size_t w = 0; w < words; w++) {
+        const double* word_values = values + w * 64;
+        size_t n                  = (count - w * 64) < 64 ? (count - w * 64) : 64;
+        uint64_t bits             = 0;
+
+        NUMERIC_OP_WORD(clause, word_values, n, literal, upper, bits);
+        out[w] = bits & valid[w] & active[w];
+    }
+}
+
+/**
+ * Checks whether any timestamp in [range->min, range->max] can satisfy a clause.
+ */
+static bool time_range_may_match(const TimeRange* range, const WhereClause* clause) {
+    if (range->min > range->max) {
+        return false;  // No timestamps in the block
+    }
+
+    switch (clause->op) {
+        case OP_GREATER:
+            return range->max > clause->time;
         case OP_GREATER_EQ:
-        case OP_LESS_EQ: {
-            char* field_end;
-            char* value_end;
-            double field_num = strtod(field_trimmed, &field_end);
-            double value_num = strtod(clause->value, &value_end);
-
-            // Check if both parsed successfully (allowing trailing whitespace)
-            while (isspace((unsigned char)*field_end)) field_end++;
-            while (isspace((unsigned char)*value_end)) value_end++;
-
-            if (*field_end != '\0' || *value_end != '\0') {
-                return false;  // Not numeric
+            return range->max >= clause->time;
+        case OP_LESS:
+            return range->min < clause->time;
+        case OP_LESS_EQ:
+            return range->min <= clause->time;
+        case OP_BETWEEN: {
+            bool low_ok  = clause->exclusive_lower ? range->max > clause->time : range->max >= clause->time;
+            bool high_ok = clause->exclusive_upper ? range->min < clause->time_upper : range->min <= clause->time_upper;
+            return low_ok && high_ok;
+        }
+        default:
+            return true;
+    }
+}
+
+/** IN lists larger than this are not probed against Bloom filters: scanning the batch is cheaper. */
+#define BLOOM_MAX_IN_PROBES WHERE_BATCH_ROWS
+
+/**
+ * Checks whether a block's Bloom filter allows a match for '=' or IN.
+ * Other operators can't use the filter and always return true.
+ */
+static bool bloom_may_match(const uint64_t* bloom, const WhereClause* clause, size_t value_len) {
+    // Filters hold case-folded hashes, so they also rule out case-sensitive matches
+    if (clause->op == OP_EQUALS || clause->op == OP_EQUALS_CS) {
+        return bloom_may_contain(bloom, hash_bytes_nocase(clause->value, value_len));
+    }
+
+    if (clause->op == OP_IN && clause->set->count <= BLOOM_MAX_IN_PROBES) {
+        const StringSet* set = clause->set;
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->slots[i].hash != 0 && bloom_may_contain(bloom, set->slots[i].hash)) {
+                return true;
             }
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Returns the bits of the 64 rows from `first` that fall within a clause's row range.
+ */
+static uint64_t range_word(const WhereClause* clause, size_t first) {
+    size_t lo = clause->range_start > first ? clause->range_start - first : 0;
+    size_t hi = clause->range_end > first ? clause->range_end - first : 0;
+    if (hi > 64) {
+        hi = 64;
+    }
+    if (lo >= hi) {
+        return 0;
+    }
+
+    uint64_t below_hi = hi == 64 ? ~(uint64_t)0 : ((uint64_t)1 << hi) - 1;
+    return below_hi & ~(((uint64_t)1 << lo) - 1);
+}
+
+/**
+ * Evaluates one condition over the active rows of a batch.
+ * Bits outside `active` are always left cleared.
+ */
+static void evaluate_clause_batch(ColumnCache* cache, const WhereClause* clause, size_t start, size_t count,
+                                  const uint64_t* active, uint64_t* out) {
+    size_t words = BITMAP_WORDS(count);
+
+    if (clause->selection != NULL) {
+        for (size_t w = 0; w < words; w++) {
+            out[w] = clause->selection[start / 64 + w] & active[w];
+        }
+        return;
+    }
+
+    if (clause->has_range) {
+        for (size_t w = 0; w < words; w++) {
+            out[w] = range_word(clause, start + w * 64) & active[w];
+        }
+        return;
+    }
+
+    if (clause->expr != NULL) {
+        evaluate_expression_batch(cache, clause, start, count, active, out);
+        return;
+    }
+
+    // Unresolved column or a literal that is neither a number nor a timestamp: nothing can match
+    if (clause->column_idx == (size_t)-1 || (clause->is_numeric && !clause->has_number && !clause->is_time)) {
+        memset(out, 0, sizeof(uint64_t) * words);
+        return;
+    }
+
+    if (clause->is_time) {
+        const TimeRange* ranges = column_cache_time_ranges(cache, clause->column_idx);
+        if (ranges != NULL && !time_range_may_match(&ranges[start / ZONE_ROWS], clause)) {
+            memset(out, 0, sizeof(uint64_t) * words);
+            return;
+        }
+
+        const TimeVector* tv = column_cache_get_times_block(cache, clause->column_idx, start);
+        if (tv == NULL) {
+            memset(out, 0, sizeof(uint64_t) * words);
+            return;
+        }
+
+        evaluate_time_batch(tv, clause, start, count, out);
+        for (size_t w = 0; w < words; w++) {
+            out[w] &= active[w];
+        }
+        return;
+    }
+
+    if (clause->is_numeric) {
+        // A block whose range can't match is skipped without parsing its cells
+        const Zone* zones = column_cache_zones(cache, clause->column_idx);
+        if (zones != NULL && !zone_may_match(&zones[start / ZONE_ROWS], clause)) {
+            memset(out, 0, sizeof(uint64_t) * words);
+            return;
+        }
+
+        const ColumnVector* vec = column_cache_get_block(cache, clause->column_idx, start);
+        if (vec == NULL) {
+            memset(out, 0, sizeof(uint64_t) * words);
+            return;
+        }
+
+        evaluate_numeric_batch(vec, clause, start, count, out);
+        for (size_t w = 0; w < words; w++) {
+            out[w] &= active[w];
+        }
+        return;
+    }
+
+    size_t value_len = clause->value != NULL ? strlen(clause->value) : 0;
+
+    // Equality lookups skip blocks whose Bloom filter rules the value out, before measuring any cell
+    const uint64_t* bloom = column_cache_bloom(cache, clause->column_idx, start);
+    if (bloom != NULL && !bloom_may_match(bloom, clause, value_len)) {
+        memset(out, 0, sizeof(uint64_t) * words);
+        return;
+    }
 
-            switch (clause->op) {
-                case OP_GREATER:
-                    return field_num > value_num;
-                case OP_LESS:
-                    return field_num < value_num;
-                case OP_GREATER_EQ:
-                    return field_num >= value_num;
-                case OP_LESS_EQ:
-                    return field_num <= value_num;
-                default:
-                    return false;
+    const FieldInfo* fields = column_cache_fields_block(cache, clause->column_idx, start);
+    if (fields == NULL) {
+        memset(out, 0, sizeof(uint64_t) * words);
+        return;
+    }
+
+    // Text operators only look at rows that are still selected
+    for (size_t w = 0; w < words; w++) {
+        uint64_t pending = active[w];
+        uint64_t bits    = 0;
+
+        while (pending != 0) {
+            unsigned j = bitmap_lowest(pending);
+            pending &= pending - 1;
+
+            size_t r = start + w * 64 + j;
+            if (column_cache_has_cell(cache, r, clause->column_idx) &&
+                evaluate_text_clause(column_cache_text(cache, r, clause->column_idx), &fields[r], clause, value_len)) {
+                bits |= (uint64_t)1 << j;
             }
         }
+        out[w] = bits;
     }
+}
 
-    return false;
+/**
+ * Recursive batch evaluator for the AST.
+ * The right side of AND only sees rows the left side kept; the right side of OR only
+ * sees rows the left side rejected, mirroring per-row short-circuiting.
+ */
+static void eval_ast_batch(ColumnCache* cache, const ASTNode* node, size_t start, size_t count,
+                           const uint64_t* active, uint64_t* out) {
+    size_t words = BITMAP_WORDS(count);
+
+    if (node->type == NODE_CONDITION) {
+        evaluate_clause_batch(cache, node->clause, start, count, active, out);
+        return;
+    }
+
+    uint64_t left[WHERE_BATCH_WORDS];
+    uint64_t rest[WHERE_BATCH_WORDS];
+    uint64_t any = 0;
+
+    eval_ast_batch(cache, node->left, start, count, active, left);
+
+    if (node->logic_op == LOGIC_AND) {
+        for (size_t w = 0; w < words; w++) any |= left[w];
+        if (any == 0) {
+            memset(out, 0, sizeof(uint64_t) * words);
+            return;
+        }
+        eval_ast_batch(cache, node->right, start, count, left, out);
+    } else {  // LOGIC_OR
+        for (size_t w = 0; w < words; w++) {
+            rest[w] = active[w] & ~left[w];
+            any |= rest[w];
+        }
+        if (any == 0) {
+            memcpy(out, left, sizeof(uint64_t) * words);
+            return;
+        }
+        eval_ast_batch(cache, node->right, start, count, rest, out);
+        for (size_t w = 0; w < words; w++) {
+            out[w] |= left[w];
+        }
+    }
 }
 
 /**
- * Recursive evaluator for the AST.
+ * Evaluates one condition over every data row.
  */
-static bool eval_ast(const Row* row, const ASTNode* node) {
-    if (!node) return true;
+void evaluate_clause_all(ColumnCache* cache, const WhereClause* clause, uint64_t* out) {
+    uint64_t active[WHERE_BATCH_WORDS];
 
-    if (node->type == NODE_LOGIC) {
-        bool l_res = eval_ast(row, node->left);
-        // Short-circuit logic
-        if (node->logic_op == LOGIC_AND) {
-            return l_res ? eval_ast(row, node->right) : false;
-        } else {  // LOGIC_OR
-            return l_res ? true : eval_ast(row, node->right);
+    for (size_t start = 0; start < cache->row_count; start += WHERE_BATCH_ROWS) {
+        size_t count = cache->row_count - start < WHERE_BATCH_ROWS ? cache->row_count - start : WHERE_BATCH_ROWS;
+        size_t words = BITMAP_WORDS(count);
+
+        for (size_t w = 0; w < words; w++) {
+            size_t n  = (count - w * 64) < 64 ? (count - w * 64) : 64;
+            active[w] = n == 64 ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
         }
-    } else {
-        // NODE_CONDITION
-        return evaluate_where_clause(row, node->clause);
+        evaluate_clause_batch(cache, clause, start, count, active, out + start / 64);
     }
 }
 
 /**
- * Evaluates the complete WHERE filter against a row.
+ * Evaluates the complete WHERE filter over a batch of data rows.
  */
-bool evaluate_where_filter(const Row* row, const WhereFilter* filter) {
-    if (!filter || !filter->root) return true;
-    return eval_ast(row, filter->root);
+void evaluate_where_batch(ColumnCache* cache, const WhereFilter* filter, size_t start, size_t count,
+                          uint64_t* out) {
+    uint64_t active[WHERE_BATCH_WORDS];
+    size_t words = BITMAP_WORDS(count);
+
+    for (size_t w = 0; w < words; w++) {
+        size_t n  = (count - w * 64) < 64 ? (count - w * 64) : 64;
+        active[w] = n == 64 ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
+    }
+
+    if (!filter || !filter->root) {
+        memcpy(out, active, sizeof(uint64_t) * words);
+        return;
+    }
+
+    eval_ast_batch(cache, filter->root, start, count, active, out);
 }
@@ -0,0 +1,155 @@
+// Built together with the cache, so the block encoding can be tested on its own
+#include "../src/predicate-cache.c"
+#include "test.h"
+
+/**
+ * Not needed by the encoding; where-parser.c refers to it. (csvq.c defines the real lookup.)
+ */
+ssize_t find_column_by_name(const Row* header, const char* name) {
+    (void)header;
+    (void)name;
+    return -1;
+}
+
+/** Full blocks of the test selection, and rows of the partial block after them. */
+#define TEST_BLOCKS       8
+#define TEST_PARTIAL_ROWS 1000
+#define TEST_ROWS         ((size_t)TEST_BLOCKS * ZONE_ROWS + TEST_PARTIAL_ROWS)
+
+/** The kind write_selection() must pick for each block, partial block last. */
+static const BlockKind expected_kinds[TEST_BLOCKS + 1] = {
+    BLOCK_EMPTY, BLOCK_FULL, BLOCK_ARRAY, BLOCK_INVERTED, BLOCK_BITMAP, BLOCK_ARRAY, BLOCK_BITMAP, BLOCK_INVERTED,
+    BLOCK_FULL,
+};
+
+/**
+ * Selects the first `count` rows of a block, spread out by a stride.
+ */
+static void select_spread(uint64_t* bits, size_t base, size_t count) {
+    size_t stride = ZONE_ROWS / count;
+    for (size_t i = 0; i < count; i++) {
+        bitmap_set(bits, base + i * stride);
+    }
+}
+
+/**
+ * Builds a selection with one block of every kind, and blocks on both sides of the
+ * ARRAY_MAX threshold.
+ */
+static void build_selection(uint64_t* bits) {
+    size_t block = ZONE_ROWS;
+
+    // 0: empty
+    // 1: full
+    for (size_t r = 0; r < block; r++) bitmap_set(bits, 1 * block + r);
+    // 2: sparse, including the first and last row
+    bitmap_set(bits, 2 * block);
+    bitmap_set(bits, 3 * block - 1);
+    for (size_t r = 0; r < block; r += 97) bitmap_set(bits, 2 * block + r);
+    // 3: dense
+    for (size_t r = 0; r < block; r++) bitmap_set(bits, 3 * block + r);
+    for (size_t r = 5; r < block; r += 101) bitmap_clear(bits, 3 * block + r);
+    // 4: half the rows
+    for (size_t r = 0; r < block; r += 2) bitmap_set(bits, 4 * block + r);
+    // 5: exactly ARRAY_MAX rows selected, 6: one more
+    select_spread(bits, 5 * block, ARRAY_MAX);
+    select_spread(bits, 6 * block, ARRAY_MAX + 1);
+    // 7: exactly ARRAY_MAX rows rejected
+    for (size_t r = 0; r < block; r++) bitmap_set(bits, 7 * block + r);
+    for (size_t i = 0; i < ARRAY_MAX; i++) bitmap_clear(bits, 7 * block + i * (block / ARRAY_MAX) + 3);
+    // Partial block: every row
+    for (size_t r = 0; r < TEST_PARTIAL_ROWS; r++) bitmap_set(bits, TEST_BLOCKS * block + r);
+}
+
+/**
+ * Walks the blocks of a written entry and checks their kinds.
+ */
+static void check_block_kinds(const char* path, const char* clause) {
+    FILE* f = fopen(path, "rb");
+    CHECK(f != NULL);
+    if (f == NULL) return;
+
+    PredicateHeader hdr;
+    CHECK(fread(&hdr, sizeof(hdr), 1, f) == 1 && fseek(f, (long)hdr.key_len, SEEK_CUR) == 0);
+    CHECK(hdr.key_len == strlen(clause));
+
+    for (size_t b = 0; b <= TEST_BLOCKS; b++) {
+        size_t rows    = b < TEST_BLOCKS ? ZONE_ROWS : TEST_PARTIAL_ROWS;
+        BlockHeader bh = {0};
+        CHECK(fread(&bh, sizeof(bh), 1, f) == 1);
+        CHECK_MSG(bh.kind == (uint32_t)expected_kinds[b], "block %zu: kind %u, expected %d", b, bh.kind,
+                  (int)expected_kinds[b]);
+
+        long payload = bh.kind == BLOCK_BITMAP ? (long)(BITMAP_WORDS(rows) * sizeof(uint64_t))
+                                               : (long)(bh.count * sizeof(uint16_t));
+        CHECK(fseek(f, payload, SEEK_CUR) == 0);
+    }
+    CHECK(fgetc(f) == EOF);
+    fclose(f);
+}
+
+/**
+ * Reads an entry back into a fresh bitmap.
+ */
+static bool read_back(const char* path, const SidecarKey* key, const char* clause, uint64_t* bits) {
+    memset(bits, 0, sizeof(uint64_t) * BITMAP_WORDS(TEST_ROWS));
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return false;
+    bool ok = read_selection(f, key, clause, bits);
+    fclose(f);
+    return ok;
+}
+
+static void test_block_round_trip(void) {
+    char path[]     = "test-predicate-cache.csvqp";
+    char tmp_path[] = "test-predicate-cache.csvqp.tmp";
+    const char* clause = "op=1 col=3 value=x";
+
+    SidecarKey key = {.file = {.size = 123, .mtime = 456, .inode = 42, .sample_hash = 789},
+                      .row_count  = TEST_ROWS,
+                      .col_count  = 4,
+                      .delimiter  = ',',
+                      .comment    = '#',
+                      .has_header = 1};
+
+    uint64_t* bits = calloc(BITMAP_WORDS(TEST_ROWS), sizeof(uint64_t));
+    uint64_t* back = calloc(BITMAP_WORDS(TEST_ROWS), sizeof(uint64_t));
+    build_selection(bits);
+
+    CHECK(write_selection(path, tmp_path, &key, clause, bits));
+    check_block_kinds(path, clause);
+
+    CHECK(read_back(path, &key, clause, back));
+    CHECK(memcmp(bits, back, sizeof(uint64_t) * BITMAP_WORDS(TEST_ROWS)) == 0);
+
+    // Entries for another condition or another file state are not used
+    CHECK(!read_back(path, &key, "op=1 col=3 value=y", back));
+    SidecarKey changed = key;
+    changed.file.mtime++;
+    CHECK(!read_back(path, &changed, clause, back));
+    changed = key;
+    changed.file.inode++;
+    CHECK(!read_back(path, &changed, clause, back));
+
+    // A truncated entry is rejected
+    FILE* f       = fopen(path, "rb");
+    char* data    = malloc(1 << 20);
+    size_t length = f != NULL ? fread(data, 1, 1 << 20, f) : 0;
+    if (f != NULL) fclose(f);
+    CHECK(length > 0 && length < (1 << 20));
+
+    f = fopen(path, "wb");
+    CHECK(f != NULL && fwrite(data, 1, length - 1, f) == length - 1);
+    if (f != NULL) fclose(f);
+    CHECK(!read_back(path, &key, clause, back));
+    free(data);
+
+    remove(path);
+    free(bits);
+    free(back);
+}
+
+int main(void) {
+    test_block_round_trip();
+    TEST_MAIN_END();
+}
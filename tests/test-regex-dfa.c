@@ -0,0 +1,234 @@
+// Built together with the engine, so the prefilter and the DFA cache can be inspected
+#include "../src/regex-dfa.c"
+#include "test.h"
+
+/** One search: pattern, input and whether it matches. */
+typedef struct {
+    const char* pattern;
+    const char* text;
+    bool match;
+} SearchCase;
+
+static const SearchCase search_cases[] = {
+    // Literals and '.'
+    {"abc", "xxabcxx", true},
+    {"abc", "abx", false},
+    {"a.c", "abc", true},
+    {"a.c", "a\nc", false},
+    {"", "", true},
+    {"", "anything", true},
+
+    // Classes
+    {"[abc]", "xxbxx", true},
+    {"[abc]", "xyz", false},
+    {"[^abc]", "abc", false},
+    {"[^abc]", "abcd", true},
+    {"[a-c]x", "bx", true},
+    {"[a-c]x", "dx", false},
+    {"[]a]", "]", true},
+    {"[^]a]", "]a", false},
+    {"[a-]", "-", true},
+    {"[\\d_]+$", "id_42", true},
+    {"[\\]]", "]", true},
+
+    // Escapes
+    {"\\d\\d", "a12", true},
+    {"\\d\\d", "a1b2", false},
+    {"\\D", "123", false},
+    {"\\w+@\\w+", "mail: bob@example", true},
+    {"\\W", "abc_123", false},
+    {"a\\sb", "a\tb", true},
+    {"\\S", " \t\n", false},
+    {"a\\.b", "a.b", true},
+    {"a\\.b", "axb", false},
+    {"\\(x\\)", "f(x)", true},
+    {"\\$5", "cost $5", true},
+    {"a\\tb", "a\tb", true},
+
+    // Case folding
+    {"(?i)hello", "Say HELLO", true},
+    {"(?i)h[a-c]llo", "HBLLO", true},
+    {"(?i)[^a]", "A", false},
+    {"hello", "HELLO", false},
+    {"(?i)\\w+", "__", true},
+
+    // Groups, alternation and quantifiers
+    {"gr(a|e)y", "grey", true},
+    {"gr(a|e)y", "gruy", false},
+    {"(?:ab)+c", "ababc", true},
+    {"(?:ab)+c", "ac", false},
+    {"colou?r", "color", true},
+    {"colou?r", "colour", true},
+    {"ab*c", "ac", true},
+    {"ab+c", "ac", false},
+    {"a+?b", "aaab", true},
+    {"(a|b)*abb", "babaabb", true},
+    {"cat|dog", "hotdog", true},
+    {"cat|dog", "cow", false},
+    {"(|x)y", "y", true},
+
+    // Bounded repeats
+    {"^x{3}$", "xxx", true},
+    {"^x{3}$", "xx", false},
+    {"^x{3}$", "xxxx", false},
+    {"^x{2,}$", "xx", true},
+    {"^x{2,}$", "x", false},
+    {"^x{2,4}$", "xxxx", true},
+    {"^x{2,4}$", "xxxxx", false},
+    {"^x{0}y$", "y", true},
+    {"^(ab){2}$", "abab", true},
+    {"a{,3}", "a{,3}", true},  // Not a bound: '{' is literal
+    {"a{x}", "a{x}", true},
+    {"^a{1000}$", "a", false},
+
+    // Anchors
+    {"^abc", "abcd", true},
+    {"^abc", "xabc", false},
+    {"abc$", "xabc", true},
+    {"abc$", "abcx", false},
+    {"^$", "", true},
+    {"^$", "x", false},
+    {"^", "x", true},
+    {"$", "x", true},
+    {"$^", "", true},
+    {"$^", "x", false},
+    {"a^b", "ab", false},
+    {"a$b", "ab", false},
+    {"^(a|b)$", "b", true},
+    {"(^a|b$)", "xxb", true},
+    {"(^a|b$)", "xax", false},
+    {"x*$", "abc", true},
+};
+
+/**
+ * Runs the search table, each pattern on its own compiled regex.
+ */
+static void test_search_table(void) {
+    for (size_t i = 0; i < sizeof(search_cases) / sizeof(search_cases[0]); i++) {
+        const SearchCase* c = &search_cases[i];
+        Regex* re           = regex_compile(c->pattern);
+        CHECK_MSG(re != NULL, "'%s' failed to compile", c->pattern);
+        if (re == NULL) continue;
+
+        bool got = regex_search(re, c->text, strlen(c->text));
+        CHECK_MSG(got == c->match, "'%s' on '%s': got %s", c->pattern, c->text, got ? "match" : "no match");
+
+        // A second search runs on the cached DFA states
+        CHECK_MSG(regex_search(re, c->text, strlen(c->text)) == got, "'%s' on '%s': cached search differs",
+                  c->pattern, c->text);
+        regex_free(re);
+    }
+}
+
+/**
+ * Patterns that must be rejected.
+ */
+static void test_invalid_patterns(void) {
+    static const char* invalid[] = {
+        "(ab", "ab)", "*a", "a|+", "[abc", "[z-a]", "a\\", "x{2,1}", "x{1001}", "x{0,1001}",
+        "(a{1000}){100}",  // Too many NFA states
+    };
+
+    fprintf(stderr, "(the following compile errors are expected)\n");
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        Regex* re = regex_compile(invalid[i]);
+        CHECK_MSG(re == NULL, "'%s' compiled", invalid[i]);
+        regex_free(re);
+    }
+}
+
+/** Expected required literal of a pattern. */
+typedef struct {
+    const char* pattern;
+    const char* literal;  // Folded for (?i)
+    bool literal_only;
+} LiteralCase;
+
+/**
+ * The prefilter literal, and patterns that need no DFA at all.
+ */
+static void test_literals(void) {
+    static const LiteralCase cases[] = {
+        {"hello", "hello", true},
+        {"(?i)HeLLo", "hello", true},
+        {"(?:abc)", "abc", true},
+        {"^hello", "hello", false},
+        {"hello$", "hello", false},
+        {"foo\\d+barbaz", "barbaz", false},
+        {"x(abc|abd)y", "x", false},  // Alternatives share no literal
+        {"error: [0-9]+", "error: ", false},
+        {"ab?c", "a", false},
+        {"a|b", "", false},
+        {"(ab){3}", "ab", false},  // Repeats keep the literal of one copy
+        {"\\.csv", ".csv", true},
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const LiteralCase* c = &cases[i];
+        Regex* re            = regex_compile(c->pattern);
+        CHECK_MSG(re != NULL, "'%s' failed to compile", c->pattern);
+        if (re == NULL) continue;
+
+        size_t len = strlen(c->literal);
+        CHECK_MSG(re->literal_len == len && memcmp(re->literal, c->literal, len) == 0,
+                  "'%s': literal '%.*s', expected '%s'", c->pattern, (int)re->literal_len, re->literal, c->literal);
+        CHECK_MSG(re->literal_only == c->literal_only, "'%s': literal_only %d", c->pattern, re->literal_only);
+        regex_free(re);
+    }
+
+    // The prefilter alone decides literal patterns, and rejects inputs for the others
+    Regex* re = regex_compile("(?i)needle");
+    CHECK(re != NULL && regex_search(re, "hay NEEDLE hay", 14) && !regex_search(re, "hay needl", 9));
+    CHECK(re != NULL && re->dfa_count == 0);
+    regex_free(re);
+
+    re = regex_compile("id=\\d+;");
+    CHECK(re != NULL && !regex_search(re, "no match here", 13));
+    CHECK(re != NULL && re->dfa_count == 0);
+    CHECK(re != NULL && regex_search(re, "x id=42; y", 10) && re->dfa_count > 0);
+    regex_free(re);
+}
+
+/**
+ * A pattern with more DFA states than the cache holds: the cache is flushed and rebuilt
+ * while searching, and results stay correct.
+ */
+static void test_dfa_cache_flush(void) {
+    // Remembers the last 13 bytes: 2^13 states, twice MAX_DFA_STATES
+    Regex* re = regex_compile("a[ab]{12}$");
+    CHECK(re != NULL);
+    if (re == NULL) return;
+
+    enum { LEN = 40, RUNS = 4000 };
+    char text[LEN];
+    uint32_t seed     = 12345;
+    bool flushed      = false;
+    int last_count    = 0;
+    size_t mismatches = 0;
+
+    for (int run = 0; run < RUNS; run++) {
+        for (int i = 0; i < LEN; i++) {
+            seed    = seed * 1103515245u + 12345u;
+            text[i] = (seed >> 16) & 1 ? 'a' : 'b';
+        }
+
+        bool expected = text[LEN - 13] == 'a';
+        mismatches += regex_search(re, text, LEN) != expected;
+
+        CHECK(re->dfa_count <= MAX_DFA_STATES);
+        flushed    = flushed || re->dfa_count < last_count;
+        last_count = re->dfa_count;
+    }
+
+    CHECK_MSG(mismatches == 0, "%zu wrong results", mismatches);
+    CHECK_MSG(flushed, "the DFA cache was never flushed");
+    regex_free(re);
+}
+
+int main(void) {
+    test_search_table();
+    test_invalid_patterns();
+    test_literals();
+    test_dfa_cache_flush();
+    TEST_MAIN_END();
+}
@@ -0,0 +1,319 @@
+#include "../include/sort-keys.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "test.h"
+
+// =============================================================================
+// REFERENCE ORDER
+// =============================================================================
+
+/** The kinds of keys, each sorted by its own sort_keys_*() function. */
+typedef enum {
+    KEYS_NUMBER,     // sort_keys_numbers()
+    KEYS_TEXT,       // sort_keys_text()
+    KEYS_COMPOSITE,  // sort_keys_composite()
+} KeyKind;
+
+/** Direction of the reference comparators (qsort() takes no context). */
+static bool ref_desc;
+
+/**
+ * Reference text order: strcasecmp(), then row, so any sort gives the stable result.
+ */
+static int ref_text(const void* a, const void* b) {
+    const SortKey* x = a;
+    const SortKey* y = b;
+    int result       = strcasecmp(x->text, y->text);
+    if (result != 0) {
+        return ref_desc ? -result : result;
+    }
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+/**
+ * Reference number order: key, then row.
+ */
+static int ref_number(const void* a, const void* b) {
+    const SortKey* x = a;
+    const SortKey* y = b;
+    if (x->key != y->key) {
+        return (x->key < y->key) == ref_desc ? 1 : -1;
+    }
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+/**
+ * Reference composite order: memcmp() of the common length, then row.
+ */
+static int ref_composite(const void* a, const void* b) {
+    const SortKey* x = a;
+    const SortKey* y = b;
+    int result       = memcmp(x->text, y->text, x->key < y->key ? x->key : y->key);
+    if (result != 0) {
+        return result;
+    }
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+/**
+ * Sorts a copy of `input` with the sort_keys_*() function of `kind` and checks the first
+ * `keep` rows (all when keep is SIZE_MAX) against the reference order.
+ */
+static void check_sort(KeyKind kind, const SortKey* input, size_t n, size_t keep, bool desc, const char* label) {
+    SortKey* keys     = malloc(sizeof(SortKey) * (n > 0 ? n : 1));
+    SortKey* expected = malloc(sizeof(SortKey) * (n > 0 ? n : 1));
+    memcpy(keys, input, sizeof(SortKey) * n);
+    memcpy(expected, input, sizeof(SortKey) * n);
+
+    ref_desc = desc;
+    bool ok;
+    if (kind == KEYS_NUMBER) {
+        qsort(expected, n, sizeof(SortKey), ref_number);
+        ok = sort_keys_numbers(keys, n, keep, desc);
+    } else if (kind == KEYS_TEXT) {
+        qsort(expected, n, sizeof(SortKey), ref_text);
+        ok = sort_keys_text(keys, n, keep, desc);
+    } else {
+        qsort(expected, n, sizeof(SortKey), ref_composite);
+        ok = sort_keys_composite(keys, n, keep);
+    }
+    CHECK_MSG(ok, "%s: sort failed", label);
+
+    size_t checked    = keep < n ? keep : n;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < checked; i++) {
+        mismatches += keys[i].row != expected[i].row;
+    }
+    CHECK_MSG(mismatches == 0, "%s (%s, keep %zu): %zu rows out of place", label, desc ? "desc" : "asc",
+              keep == SIZE_MAX ? n : keep, mismatches);
+
+    free(keys);
+    free(expected);
+}
+
+/**
+ * Fills text keys as the sort expects them: inline prefix, full text, input row.
+ */
+static void fill_text_keys(SortKey* keys, char** texts, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = (SortKey){sort_key_prefix(texts[i]), texts[i], i};
+    }
+}
+
+/**
+ * Sorts text keys and checks every row against the reference order.
+ */
+static void check_text_sort(char** texts, size_t n, bool desc, const char* label) {
+    SortKey* keys     = malloc(sizeof(SortKey) * n);
+    SortKey* expected = malloc(sizeof(SortKey) * n);
+    fill_text_keys(keys, texts, n);
+    fill_text_keys(expected, texts, n);
+
+    ref_desc = desc;
+    qsort(expected, n, sizeof(SortKey), ref_text);
+    CHECK(sort_keys_text(keys, n, SIZE_MAX, desc));
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++) {
+        mismatches += keys[i].row != expected[i].row;
+    }
+    CHECK_MSG(mismatches == 0, "%s (%s): %zu rows out of place", label, desc ? "desc" : "asc", mismatches);
+
+    free(keys);
+    free(expected);
+}
+
+/**
+ * Allocates `len` bytes of `fill` followed by `tail` (may be empty).
+ */
+static char* make_text(size_t len, char fill, const char* tail) {
+    size_t tail_len = strlen(tail);
+    char* text      = malloc(len + tail_len + 1);
+    memset(text, fill, len);
+    memcpy(text + len, tail, tail_len + 1);
+    return text;
+}
+
+/** Frees texts made by make_text(). */
+static void free_texts(char** texts, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        free(texts[i]);
+    }
+}
+
+// =============================================================================
+// TEXT SORT
+// =============================================================================
+
+/**
+ * Long identical cells used to nest one stack frame per shared byte.
+ */
+static void test_long_identical_text(void) {
+    enum { N = 100, LEN = 200000 };
+    char* texts[N];
+    for (size_t i = 0; i < N; i++) {
+        texts[i] = make_text(LEN, i % 2 ? 'A' : 'a', "");  // Equal once folded
+    }
+    check_text_sort(texts, N, false, "long identical");
+    check_text_sort(texts, N, true, "long identical");
+    free_texts(texts, N);
+}
+
+/**
+ * Long shared heads that diverge only at the end, or at several depths.
+ */
+static void test_long_shared_prefix(void) {
+    enum { N = 300, LEN = 50000 };
+    char* texts[N];
+    for (size_t i = 0; i < N; i++) {
+        char tail[64];
+        snprintf(tail, sizeof(tail), "%03zu/%c/%zu", (i * 7) % N, 'a' + (int)(i % 26), i % 5);
+        texts[i] = make_text(LEN + (i % 3) * 9, 'x', tail);
+    }
+    check_text_sort(texts, N, false, "long shared prefix");
+    check_text_sort(texts, N, true, "long shared prefix");
+    free_texts(texts, N);
+}
+
+/**
+ * Texts that split off one key per byte, so bucket splits nest deeper than the
+ * bucketing limit and the rest is finished by a comparison sort.
+ */
+static void test_deep_bucket_splits(void) {
+    enum { N = 400 };
+    char* texts[N];
+    for (size_t i = 0; i < N; i++) {
+        texts[i] = make_text((i * 37) % N, 'a', i % 2 ? "b" : "B-tail");
+    }
+    check_text_sort(texts, N, false, "deep splits");
+    check_text_sort(texts, N, true, "deep splits");
+    free_texts(texts, N);
+}
+
+/**
+ * Mixed short texts: empty cells, case differences and texts that prefix each other.
+ */
+static void test_short_text(void) {
+    static const char* words[] = {"", "a", "A", "ab", "abc", "abcdefgh", "abcdefghi", "ABCDEFGHI", "b", "zz", "Zz"};
+    enum { N = 1000 };
+    char* texts[N];
+    for (size_t i = 0; i < N; i++) {
+        texts[i] = strdup(words[(i * 13) % (sizeof(words) / sizeof(words[0]))]);
+    }
+    check_text_sort(texts, N, false, "short");
+    check_text_sort(texts, N, true, "short");
+    free_texts(texts, N);
+}
+
+// =============================================================================
+// ALL KINDS: THREADS, TOP-K AND SPILLS
+// =============================================================================
+
+/** Keys of every kind over the same rows, with many duplicates to check stability. */
+typedef struct {
+    SortKey* numbers;
+    SortKey* texts;
+    SortKey* composites;
+    char** strings;
+    unsigned char* bytes;
+    size_t n;
+} KeySets;
+
+/** Next value of a small deterministic generator. */
+static uint32_t next_random(uint32_t* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 8;
+}
+
+/**
+ * Builds `n` keys of each kind. Composite keys order on a text and then a descending number.
+ */
+static KeySets make_key_sets(size_t n, uint32_t seed) {
+    static const char* words[] = {"apple", "Apple", "banana", "cherry", "", "apples", "date", "zebra-crossing-long"};
+    KeySets k    = {0};
+    k.n          = n;
+    k.numbers    = malloc(sizeof(SortKey) * (n + 1));
+    k.texts      = malloc(sizeof(SortKey) * (n + 1));
+    k.composites = malloc(sizeof(SortKey) * (n + 1));
+    k.strings    = malloc(sizeof(char*) * (n + 1));
+    k.bytes      = malloc(64 * (n + 1));
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t r    = next_random(&seed);
+        double number = (double)((int)(r % 200) - 100) / 4;  // Negatives, zero and duplicates
+        if (r % 97 == 0) {
+            number = -0.0;
+        }
+        k.numbers[i] = (SortKey){sort_key_number(number), NULL, i};
+
+        char text[64];
+        snprintf(text, sizeof(text), "%s%u", words[r % 8], (unsigned)(r >> 3) % 7);
+        k.strings[i] = strdup(text);
+        k.texts[i]   = (SortKey){sort_key_prefix(k.strings[i]), k.strings[i], i};
+
+        unsigned char* out = k.bytes + 64 * i;
+        size_t len         = sort_key_encode_text(out, words[r % 8], false);
+        len += (r % 5 == 0) ? sort_key_encode_blank(out + len, true) : sort_key_encode_number(out + len, number, true);
+        k.composites[i] = (SortKey){len, (const char*)out, i};
+    }
+    return k;
+}
+
+/** Frees keys made by make_key_sets(). */
+static void free_key_sets(KeySets* k) {
+    free_texts(k->strings, k->n);
+    free(k->strings);
+    free(k->numbers);
+    free(k->texts);
+    free(k->composites);
+    free(k->bytes);
+}
+
+/**
+ * Checks every kind in both directions, for a full sort and several `keep` values.
+ */
+static void check_all_kinds(const KeySets* k, const char* label) {
+    size_t keeps[] = {SIZE_MAX, 0, 1, 7, k->n / 16, k->n / 3, k->n};
+    for (size_t i = 0; i < sizeof(keeps) / sizeof(keeps[0]); i++) {
+        for (int desc = 0; desc < 2; desc++) {
+            check_sort(KEYS_NUMBER, k->numbers, k->n, keeps[i], desc, label);
+            check_sort(KEYS_TEXT, k->texts, k->n, keeps[i], desc, label);
+        }
+        check_sort(KEYS_COMPOSITE, k->composites, k->n, keeps[i], false, label);
+    }
+}
+
+/**
+ * The single-threaded path and the parallel sort and merge with forced thread counts,
+ * including counts that leave uneven chunks and odd numbers of runs.
+ */
+static void test_threads(void) {
+    size_t sizes[]   = {0, 1, 2, 5, 100, 1000, 5003};
+    size_t threads[] = {1, 2, 3, 4, 7, 8, 64};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        KeySets k = make_key_sets(sizes[s], (uint32_t)sizes[s] + 1);
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            char label[64];
+            snprintf(label, sizeof(label), "%zu keys, %zu threads", sizes[s], threads[t]);
+            sort_keys_set_threads(threads[t]);
+            check_all_kinds(&k, label);
+        }
+        free_key_sets(&k);
+    }
+
+    sort_keys_set_threads(0);
+    KeySets k = make_key_sets(3000, 99);
+    check_all_kinds(&k, "default threads");
+    free_key_sets(&k);
+}
+
+int main(void) {
+    test_short_text();
+    test_long_identical_text();
+    test_long_shared_prefix();
+    test_deep_bucket_splits();
+    test_threads();
+    TEST_MAIN_END();
+}
@@ -0,0 +1,111 @@
+#include "../include/timestamp.h"
+#include <string.h>
+#include "test.h"
+
+/** One input and the microseconds it parses to; `valid` false means it must be rejected. */
+typedef struct {
+    const char* text;
+    bool valid;
+    int64_t micros;
+} TimestampCase;
+
+static const TimestampCase cases[] = {
+    // Dates
+    {"1970-01-01", true, 0},
+    {"1600-03-01", true, INT64_C(-11670912000000000)},
+    {"9999-12-31T23:59:59", true, INT64_C(253402300799000000)},
+    {"2024-00-10", false, 0},
+    {"2024-13-10", false, 0},
+    {"2024-04-31", false, 0},
+    {"2024-03-00", false, 0},
+    {"24-03-10", false, 0},
+    {"2024/03/10", false, 0},
+    {"2024-3-10", false, 0},
+
+    // Leap days
+    {"2024-02-29", true, INT64_C(1709164800000000)},
+    {"2000-02-29", true, INT64_C(951782400000000)},
+    {"2023-02-29", false, 0},
+    {"1900-02-29", false, 0},
+    {"2024-02-30", false, 0},
+
+    // Times
+    {"2024-03-10T12:34", true, INT64_C(1710074040000000)},
+    {"2024-03-10T12:34:56", true, INT64_C(1710074096000000)},
+    {"2024-03-10 12:34:56", true, INT64_C(1710074096000000)},
+    {"2024-03-10t12:34:56", true, INT64_C(1710074096000000)},
+    {"2024-03-10T24:00", false, 0},
+    {"2024-03-10T12:60", false, 0},
+    {"2024-03-10T12", false, 0},
+    {"2024-03-10T12:34:5", false, 0},
+    {"2024-03-10T", false, 0},
+    {"2024-03-10X12:34", false, 0},
+
+    // Fractions
+    {"2024-03-10 12:34:56.5", true, INT64_C(1710074096500000)},
+    {"2024-03-10T12:34:56,5", true, INT64_C(1710074096500000)},
+    {"2024-03-10T12:34:56.123456", true, INT64_C(1710074096123456)},
+    {"2024-03-10T12:34:56.1234567", true, INT64_C(1710074096123456)},  // Digits past 6 are dropped
+    {"2024-03-10T12:34:56.123456999999", true, INT64_C(1710074096123456)},
+    {"1969-12-31T23:59:59.999999", true, INT64_C(-1)},
+    {"2024-03-10T12:34:56.", false, 0},
+
+    // Zones
+    {"2024-03-10T12:34:56Z", true, INT64_C(1710074096000000)},
+    {"2024-03-10T12:34:56z", true, INT64_C(1710074096000000)},
+    {"2024-03-10T12:34:56+05", true, INT64_C(1710056096000000)},
+    {"2024-03-10T12:34:56+0500", true, INT64_C(1710056096000000)},
+    {"2024-03-10T12:34:56+05:00", true, INT64_C(1710056096000000)},
+    {"2024-03-10T12:34:56+05:30", true, INT64_C(1710054296000000)},
+    {"2024-03-10T12:34:56-0330", true, INT64_C(1710086696000000)},
+    {"2024-03-10T12:34:56.5+05:30", true, INT64_C(1710054296500000)},
+    {"2024-03-10T12:34:56+5", false, 0},
+    {"2024-03-10T12:34:56+050", false, 0},
+    {"2024-03-10T12:34:56+05:0", false, 0},
+    {"2024-03-10T12:34:56+24:00", false, 0},
+    {"2024-03-10T12:34:56+05:60", false, 0},
+
+    // Trailing garbage
+    {"2024-03-10 ", false, 0},
+    {"2024-03-10x", false, 0},
+    {"2024-03-10T12:34:56ZZ", false, 0},
+    {"2024-03-10T12:34:56Z ", false, 0},
+    {"2024-03-10T12:34:56+05:00:00", false, 0},
+    {"2024-03-10T12:34:56 UTC", false, 0},
+    {"", false, 0},
+};
+
+/**
+ * Runs the table; each case must give the same result however the span is terminated.
+ */
+static void test_cases(void) {
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const TimestampCase* c = &cases[i];
+        int64_t micros         = 0;
+        bool valid             = parse_timestamp(c->text, strlen(c->text), &micros);
+
+        CHECK_MSG(valid == c->valid, "'%s': %s", c->text, valid ? "accepted" : "rejected");
+        if (valid && c->valid) {
+            CHECK_MSG(micros == c->micros, "'%s': %lld, expected %lld", c->text, (long long)micros,
+                      (long long)c->micros);
+        }
+    }
+}
+
+/**
+ * The span ends at `len`, not at a NUL: bytes past it are never read.
+ */
+static void test_span(void) {
+    const char* text = "2024-03-10T12:34:56Zjunk";
+    int64_t micros   = 0;
+    CHECK(parse_timestamp(text, 20, &micros) && micros == INT64_C(1710074096000000));
+    CHECK(parse_timestamp(text, 10, &micros) && micros == INT64_C(1710028800000000));
+    CHECK(!parse_timestamp(text, 9, &micros));
+    CHECK(!parse_timestamp(text, 21, &micros));
+}
+
+int main(void) {
+    test_cases();
+    test_span();
+    TEST_MAIN_END();
+}
@@ -0,0 +1,129 @@
+#include "../include/where-parser.h"
+#include <string.h>
+#include <strings.h>
+#include "test.h"
+
+/**
+ * Resolves nothing: clauses keep their names, which is all the parser tests look at.
+ * (csvq.c defines the real lookup.)
+ */
+ssize_t find_column_by_name(const Row* header, const char* name) {
+    (void)header;
+    (void)name;
+    return -1;
+}
+
+/**
+ * Parses a where clause into a fresh filter.
+ * @return The root node, or NULL if parsing failed.
+ */
+static ASTNode* parse(Arena* arena, const char* where, WhereFilter* filter) {
+    memset(filter, 0, sizeof(*filter));
+    return parse_where_clause(arena, where, filter) ? filter->root : NULL;
+}
+
+/**
+ * Checks that a node is a single condition with the given column, operator and value.
+ */
+static void check_condition(const ASTNode* node, const char* column, CompareOp op, const char* value,
+                            const char* where) {
+    CHECK_MSG(node != NULL && node->type == NODE_CONDITION, "%s: not a condition", where);
+    if (node == NULL || node->type != NODE_CONDITION) {
+        return;
+    }
+
+    const WhereClause* wc = node->clause;
+    CHECK_MSG(strcasecmp(wc->column_name, column) == 0, "%s: column '%s', expected '%s'", where, wc->column_name,
+              column);
+    CHECK_MSG(wc->op == op, "%s: operator %d, expected %d", where, (int)wc->op, (int)op);
+    if (value != NULL) {
+        CHECK_MSG(strcmp(wc->value, value) == 0, "%s: value '%s', expected '%s'", where, wc->value, value);
+    }
+}
+
+/**
+ * Checks that a clause parses into `left <logic> right`, two plain conditions.
+ */
+static void check_pair(Arena* arena, const char* where, LogicOp logic, const char* left_col, CompareOp left_op,
+                       const char* left_value, const char* right_col, CompareOp right_op, const char* right_value) {
+    WhereFilter filter;
+    ASTNode* root = parse(arena, where, &filter);
+    CHECK_MSG(root != NULL && root->type == NODE_LOGIC && root->logic_op == logic, "%s: expected two conditions joined by %s", where,
+              logic == LOGIC_AND ? "AND" : "OR");
+    if (root != NULL && root->type == NODE_LOGIC) {
+        check_condition(root->left, left_col, left_op, left_value, where);
+        check_condition(root->right, right_col, right_op, right_value, where);
+    }
+    free_where_filter(&filter);
+}
+
+/**
+ * Checks that a clause parses into a single condition.
+ */
+static void check_single(Arena* arena, const char* where, const char* column, CompareOp op, const char* value) {
+    WhereFilter filter;
+    ASTNode* root = parse(arena, where, &filter);
+    CHECK_MSG(root != NULL, "%s: failed to parse", where);
+    check_condition(root, column, op, value, where);
+    free_where_filter(&filter);
+}
+
+// =============================================================================
+// BETWEEN
+// =============================================================================
+
+static void test_between(void) {
+    Arena* arena = arena_create(0);
+
+    WhereFilter filter;
+    ASTNode* root = parse(arena, "age between 18 and 65", &filter);
+    check_condition(root, "age", OP_BETWEEN, NULL, "age between 18 and 65");
+    CHECK(root != NULL && root->clause->has_number && root->clause->number == 18 && root->clause->upper == 65);
+
+    check_pair(arena, "age BETWEEN 1 AND 5 AND name = bob", LOGIC_AND, "age", OP_BETWEEN, NULL, "name", OP_EQUALS,
+               "bob");
+
+    // BETWEEN inside another condition's value does not take the next AND
+    check_single(arena, "note contains between", "note", OP_CONTAINS, "between");
+    check_pair(arena, "note contains between AND age > 5", LOGIC_AND, "note", OP_CONTAINS, "between", "age",
+               OP_GREATER, "5");
+    check_pair(arena, "note = stuck between AND x = y", LOGIC_AND, "note", OP_EQUALS, "stuck between", "x", OP_EQUALS,
+               "y");
+
+    // A BETWEEN without its AND is an error, not an unfiltered run
+    CHECK(parse(arena, "age between 3", &filter) == NULL);
+
+    arena_destroy(arena);
+}
+
+// =============================================================================
+// IN
+// =============================================================================
+
+static void test_in(void) {
+    Arena* arena = arena_create(0);
+
+    check_single(arena, "status in (open, 'on hold')", "status", OP_IN, NULL);
+    check_single(arena, "tags IN(a=b, c>d)", "tags", OP_IN, NULL);
+    check_pair(arena, "status in (open, closed) AND age > 5", LOGIC_AND, "status", OP_IN, NULL, "age", OP_GREATER,
+               "5");
+    check_pair(arena, "(status in (a, b)) OR x = 1", LOGIC_OR, "status", OP_IN, NULL, "x", OP_EQUALS, "1");
+
+    // "in (" after another operator is part of that operator's value
+    check_single(arena, "title contains made in (usa)", "title", OP_CONTAINS, "made in (usa)");
+    check_single(arena, "note = stuck in (traffic)", "note", OP_EQUALS, "stuck in (traffic)");
+    check_pair(arena, "note = stuck in (traffic) AND age > 5", LOGIC_AND, "note", OP_EQUALS, "stuck in (traffic)",
+               "age", OP_GREATER, "5");
+    check_pair(arena, "(note != in (x)) OR age < 3", LOGIC_OR, "note", OP_NOT_EQUALS, "in (x)", "age", OP_LESS, "3");
+
+    WhereFilter filter;
+    CHECK(parse(arena, "status in (open, closed", &filter) == NULL);
+
+    arena_destroy(arena);
+}
+
+int main(void) {
+    test_between();
+    test_in();
+    TEST_MAIN_END();
+}
@@ -0,0 +1,42 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Minimal test harness: CHECK() reports a failed condition and counts it,
+ * TEST_MAIN_END() turns the count into the exit status.
+ */
+
+static int test_failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                         \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_MSG(cond, ...)                                                         \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                            \
+            fprintf(stderr, "\n");                                                   \
+            test_failures++;                                                         \
+        }                                                                            \
+    } while (0)
+
+#define TEST_MAIN_END()                                                           \
+    do {                                                                          \
+        if (test_failures > 0) {                                                  \
+            fprintf(stderr, "%s: %d check(s) failed\n", __FILE__, test_failures); \
+            return EXIT_FAILURE;                                                  \
+        }                                                                         \
+        printf("%s: ok\n", __FILE__);                                             \
+        return EXIT_SUCCESS;                                                      \
+    } while (0)
+
+#endif  // TEST_H